@@ -40,6 +40,9 @@
 #define HEADERS_H
 
 #include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <locale.h>
 #include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -53,6 +56,9 @@
 #if defined(__SSE2__)
 #include <emmintrin.h>
 #endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 #if defined(__AVX2__)
 #include <immintrin.h>
 #endif
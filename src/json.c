@@ -36,20 +36,92 @@
     OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* madvise() and posix_fadvise() hints and strtod_l() under -std=c89 */
+#endif
+
 #include "json.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h> /* worker threads of the parallel parsers */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <xlocale.h> /* strtod_l() */
+#endif
+#endif
+
 #define SSE2_CHUNK_SIZE 16
 
+/* SSE2-only x86 builds still carry the SSSE3 UTF-8 kernel and pick it at run time */
+#if UTF8_VALIDATION && !defined(__SSSE3__) && defined(__SSE2__) && defined(__GNUC__)
+#include <tmmintrin.h>
+#define UTF8_RUNTIME_SSSE3
+#endif
+
 extern bool whitespace_lookup[LOOKUP_TABLE_SIZE];
 extern const signed char hex_lookup[256];
+extern const uint8_t value_lookup[LOOKUP_TABLE_SIZE];
 
 #define JSON_NULL_LEN 4
 #define JSON_TRUE_LEN 4
 #define JSON_FALSE_LEN 5
 #define HEX_LOOKUP 5
 #define MIN_PRINTABLE_ASCII 0x20
-#define MAX_PRINTABLE_ASCII 0x80
-#ifndef _WIN32
+#define UNICODE_REPLACEMENT 0xFFFD
+#define MAX_ASCII 0x80
+#define MAX_FAST_DIGITS 19                  /* significant decimal digits that always fit in uint64_t */
+#define MAX_FAST_MANTISSA (1ULL << 53)      /* largest mantissa exactly representable as double */
+#define MAX_FAST_EXPONENT 22                /* largest power of ten exactly representable as double */
+#define MAX_EXPONENT_DIGITS_VALUE 0x10000   /* clamp for absurd exponents, far outside double range */
+#define MAX_NUMBER_BUFFER 0x40              /* stack buffer for the strtod() fallback */
+/* the exact fast path needs every operation rounded once to double, x87 extended precision rounds twice */
+#if FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1
+#define FAST_DOUBLE_PATH 1
+#else
+#define FAST_DOUBLE_PATH 0
+#endif
+#define BIT_STACK_WORDS ((JSON_STACK_SIZE + 63) / 64) /* one bit per nesting level, for the allocation-free walkers */
+#define JSON_STACK_INITIAL_SIZE 0x40        /* depth handled without touching the heap */
+#define JSON_STREAM_BLOCK_SIZE 0x10000      /* arena block of the incremental parser */
+#define JSON_STREAM_PENDING_SIZE 0x100      /* initial carry buffer of the incremental parser */
+
+/* value_lookup classes, indexed by the first byte of a value */
+#define VALUE_INVALID 0
+#define VALUE_OBJECT 1
+#define VALUE_ARRAY 2
+#define VALUE_STRING 3
+#define VALUE_TRUE 4
+#define VALUE_FALSE 5
+#define VALUE_NULL 6
+#define VALUE_NUMBER 7
+#define VALUE_CLASSES 8
+
+/* json_stream.state values */
+#define STREAM_VALUE 0        /* expecting a value for ctx->current */
+#define STREAM_ARRAY_FIRST 1  /* after '[', expecting a value or ']' */
+#define STREAM_OBJECT_FIRST 2 /* after '{', expecting a key or '}' */
+#define STREAM_OBJECT_KEY 3   /* after ',' in an object, expecting a key */
+#define STREAM_OBJECT_COLON 4 /* after a key, expecting ':' */
+#define STREAM_NEXT 5         /* after a value, expecting ',' or the closing bracket */
+#define STREAM_DONE 6         /* top-level value complete, only whitespace may follow */
+#define STREAM_FAILED 7       /* invalid input seen */
+
+/* outcome of scanning one token of a stream chunk */
+#define TOKEN_OK 0
+#define TOKEN_PARTIAL 1 /* token runs into the end of the chunk */
+#define TOKEN_INVALID 2
+
+#define JSON_RECORD_SEPARATOR '\x1E' /* starts each text of an RFC 7464 JSON text sequence */
+
+/* parse_iterative() modes */
+#define PARSE_IN_SITU 0x01 /* unescape strings inside the writable input */
+#define PARSE_PADDED 0x02  /* JSON_PADDING zero bytes follow the input */
+
+#if defined(__GNUC__) && !defined(NO_COMPUTED_GOTO)
+#define COMPUTED_GOTO
 #endif
 
 typedef struct {
@@ -60,17 +132,48 @@ typedef struct {
 
 #ifndef USE_ALLOC
 static json_array_node json_array_node_pool[JSON_VALUE_POOL_SIZE];
-static size_t next_array_index = 0;
-
 static json_object_node json_object_node_pool[JSON_VALUE_POOL_SIZE];
-static size_t next_object_index = 0;
 #endif
 
+/* node pools and depth stack of one parsing thread */
+typedef struct json_context {
+  json_array_node *array_nodes;
+  size_t next_array_index;
+  json_object_node *object_nodes;
+  size_t next_object_index;
+  /* depth stack of json_parse_iterative(), grown on demand and kept between calls */
+  json_value **stack;
+  size_t stack_capacity;
+  json_value *stack_storage[JSON_STACK_INITIAL_SIZE];
+} json_context;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+static json_context default_context = {json_array_node_pool, 0, json_object_node_pool, 0, default_context.stack_storage, JSON_STACK_INITIAL_SIZE, {NULL}};
+
+/* every thread starts on the shared pools; json_parse_lines_parallel() workers switch to their own */
+static THREAD_LOCAL json_context *context = &default_context;
+
 static json_value *json_object_get(const json_value *obj, const char *key, size_t len);
 
 static bool skip_whitespace(const char **s, const char *end);
+static bool skip_whitespace_padded(const char **s, const char *end);
+static bool json_stack_grow(void);
+static bool parse_literal(const char **s, const char *end, json_value *v, uint8_t kind);
 static bool parse_number(const char **s, const char *end, json_value *v);
 static bool parse_string(const char **s, const char *end, json_value *v);
+static size_t string_unescape(const char *p, const char *end, char *dst);
+static bool parse_string_in_situ(const char **s, const char *end, json_value *v);
+static bool parse_iterative(const char *s, const char *end, json_value *root, const char **stop);
+#if UTF8_VALIDATION
+static bool utf8_validate(const char *s, size_t len);
+#endif
 static bool parse_array(const char **s, const char *end, json_value *v);
 static bool parse_object(const char **s, const char *end, json_value *v);
 static bool parse_json(const char **s, const char *end, json_value *v);
@@ -92,6 +195,10 @@ static int buffer_write_value(buffer *b, const json_value *v);
 static int buffer_write(buffer *b, const char *data, size_t len);
 static int buffer_putc(buffer *b, char c);
 
+static bool number_to_integer(const char *s, size_t len, bool *negative, uint64_t *out);
+static bool number_to_double(const char *s, size_t len, double *out);
+static bool number_to_double_slow(const char *s, size_t len, double *out);
+
 static bool json_array_equal(const json_value *a, const json_value *b);
 static bool json_object_equal(const json_value *a, const json_value *b);
 
@@ -167,6 +274,28 @@ static INLINE json_value INLINE_ATTRIBUTE *json_object_get(const json_value *obj
   return NULL;
 }
 
+static bool json_stack_grow(void) {
+  size_t capacity;
+  json_value **stack;
+  if (context->stack_capacity >= JSON_STACK_SIZE)
+    return false;
+  capacity = context->stack_capacity * 2;
+  if (capacity > JSON_STACK_SIZE)
+    capacity = JSON_STACK_SIZE;
+  if (context->stack == context->stack_storage) {
+    stack = (json_value **)malloc(capacity * sizeof(json_value *));
+    if (stack)
+      memcpy(stack, context->stack_storage, sizeof(context->stack_storage));
+  } else {
+    stack = (json_value **)realloc(context->stack, capacity * sizeof(json_value *));
+  }
+  if (!stack)
+    return false;
+  context->stack = stack;
+  context->stack_capacity = capacity;
+  return true;
+}
+
 static INLINE bool INLINE_ATTRIBUTE skip_whitespace(const char **s, const char *end) {
   if (*s == end)
     return false;
@@ -178,14 +307,294 @@ static INLINE bool INLINE_ATTRIBUTE skip_whitespace(const char **s, const char *
   return offset > 0;
 }
 
+static INLINE bool INLINE_ATTRIBUTE skip_whitespace_padded(const char **s, const char *end) {
+  /* the zero byte at end is not whitespace, so the loop needs no bounds check */
+  while (whitespace_lookup[(unsigned char)**s])
+    (*s)++;
+  return *s < end;
+}
+
+static INLINE bool INLINE_ATTRIBUTE literal_equal(const char *s, const char *literal) {
+  uint32_t word;
+  uint32_t expected;
+  /* one 32-bit load, memcpy() keeps it safe for unaligned input */
+  memcpy(&word, s, sizeof(word));
+  memcpy(&expected, literal, sizeof(expected));
+  return word == expected;
+}
+
+static INLINE bool INLINE_ATTRIBUTE parse_literal(const char **s, const char *end, json_value *v, uint8_t kind) {
+  const char *p = *s;
+  switch (kind) {
+  case VALUE_TRUE:
+    if (end - p < JSON_TRUE_LEN || !literal_equal(p, "true"))
+      return false;
+    v->type = J_BOOLEAN;
+    v->u.boolean.ptr = p;
+    v->u.boolean.len = JSON_TRUE_LEN;
+    *s = p + JSON_TRUE_LEN;
+    return true;
+  case VALUE_FALSE:
+    /* 'f' is already known from the dispatch, compare the remaining four bytes */
+    if (end - p < JSON_FALSE_LEN || !literal_equal(p + 1, "alse"))
+      return false;
+    v->type = J_BOOLEAN;
+    v->u.boolean.ptr = p;
+    v->u.boolean.len = JSON_FALSE_LEN;
+    *s = p + JSON_FALSE_LEN;
+    return true;
+  case VALUE_NULL:
+    if (end - p < JSON_NULL_LEN || !literal_equal(p, "null"))
+      return false;
+    v->type = J_NULL;
+    v->u.string.ptr = p;
+    v->u.string.len = JSON_NULL_LEN;
+    *s = p + JSON_NULL_LEN;
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* --- number conversion helpers --- */
+
+static const double power_of_ten[MAX_FAST_EXPONENT + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static INLINE bool INLINE_ATTRIBUTE number_to_integer(const char *s, size_t len, bool *negative, uint64_t *out) {
+  const char *p = s;
+  const char *end = s + len;
+  uint64_t value = 0;
+  *negative = p < end && *p == '-';
+  if (*negative)
+    p++;
+  if (p == end)
+    return false;
+  for (; p < end; p++) {
+    unsigned digit = (unsigned)((unsigned char)*p - '0');
+    if (digit > 9)
+      return false; /* fraction or exponent part */
+    if (value > (UINT64_MAX - digit) / 10)
+      return false;
+    value = value * 10 + digit;
+  }
+  *out = value;
+  return true;
+}
+
+/* strtod() honours the process-wide LC_NUMERIC, which another thread may change
+   while a parallel parser converts; the fallback converts in a private "C" locale */
+#ifdef _WIN32
+static _locale_t number_locale;
+
+static double number_strtod(const char *s, char **stop) {
+  if (!number_locale) {
+    _locale_t locale = _create_locale(LC_NUMERIC, "C");
+    if (locale && InterlockedCompareExchangePointer((PVOID volatile *)&number_locale, locale, NULL) != NULL)
+      _free_locale(locale);
+  }
+  if (!number_locale) {
+    *stop = (char *)s;
+    return 0;
+  }
+  return _strtod_l(s, stop, number_locale);
+}
+#else
+static locale_t number_locale;
+static pthread_once_t number_locale_once = PTHREAD_ONCE_INIT;
+
+static void number_locale_init(void) {
+  number_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+}
+
+static double number_strtod(const char *s, char **stop) {
+  pthread_once(&number_locale_once, number_locale_init);
+  if (!number_locale) {
+    *stop = (char *)s;
+    return 0;
+  }
+  return strtod_l(s, stop, number_locale);
+}
+#endif
+
+static bool number_to_double_slow(const char *s, size_t len, double *out) {
+  char buffer[MAX_NUMBER_BUFFER];
+  char *copy = len < sizeof(buffer) ? buffer : (char *)malloc(len + 1);
+  if (!copy)
+    return false;
+  memcpy(copy, s, len);
+  copy[len] = '\0';
+  char *stop;
+  errno = 0;
+  double value = number_strtod(copy, &stop);
+  bool result = stop == copy + len && !(errno == ERANGE && (value == HUGE_VAL || value == -HUGE_VAL));
+  if (copy != buffer)
+    free(copy);
+  if (result)
+    *out = value;
+  return result;
+}
+
+static INLINE bool INLINE_ATTRIBUTE number_to_double(const char *s, size_t len, double *out) {
+  const char *p = s;
+  const char *end = s + len;
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool negative = p < end && *p == '-';
+  if (negative)
+    p++;
+  for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    if (mantissa == 0 && *p == '0')
+      continue;
+    if (digits == MAX_FAST_DIGITS)
+      return number_to_double_slow(s, len, out);
+    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    digits++;
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+      exponent--;
+      if (mantissa == 0 && *p == '0')
+        continue;
+      if (digits == MAX_FAST_DIGITS)
+        return number_to_double_slow(s, len, out);
+      mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+      digits++;
+    }
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    bool exponent_negative = false;
+    int value = 0;
+    p++;
+    if (p < end && (*p == '+' || *p == '-'))
+      exponent_negative = *p++ == '-';
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      if (value < MAX_EXPONENT_DIGITS_VALUE)
+        value = value * 10 + (*p - '0');
+    }
+    exponent += exponent_negative ? -value : value;
+  }
+  if (p != end)
+    return false;
+  if (mantissa == 0) {
+    *out = negative ? -0.0 : 0.0;
+    return true;
+  }
+  if (!FAST_DOUBLE_PATH || mantissa > MAX_FAST_MANTISSA || exponent < -MAX_FAST_EXPONENT || exponent > MAX_FAST_EXPONENT)
+    return number_to_double_slow(s, len, out);
+  double value = (double)mantissa;
+  if (exponent < 0)
+    value /= power_of_ten[-exponent];
+  else
+    value *= power_of_ten[exponent];
+  *out = negative ? -value : value;
+  return true;
+}
+
+#ifdef NUMBER_DECODING
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_WIN32)
+#define SWAR_DIGITS
+#define SWAR_CHUNK_SIZE 8
+
+static INLINE bool INLINE_ATTRIBUTE is_eight_digits(uint64_t chunk) {
+  /* every byte is 0x30..0x39: high nibble 3 before and after adding 6 */
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static INLINE uint32_t INLINE_ATTRIBUTE parse_eight_digits(uint64_t chunk) {
+  const uint64_t mask = 0x000000FF000000FFULL;
+  const uint64_t mul1 = 0x000F424000000064ULL; /* 100 + (1000000 << 32) */
+  const uint64_t mul2 = 0x0000271000000001ULL; /* 1 + (10000 << 32) */
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+  return (uint32_t)chunk;
+}
+#endif
+
+static INLINE const char *INLINE_ATTRIBUTE scan_digits(const char *p, const char *end, uint64_t *mantissa, int *digits) {
+  uint64_t value = *mantissa;
+  int count = *digits;
+#ifdef SWAR_DIGITS
+  while (count + SWAR_CHUNK_SIZE <= MAX_FAST_DIGITS && end - p >= SWAR_CHUNK_SIZE) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    if (!is_eight_digits(chunk))
+      break;
+    value = value * 100000000ULL + parse_eight_digits(chunk);
+    count += SWAR_CHUNK_SIZE;
+    p += SWAR_CHUNK_SIZE;
+  }
+#endif
+  while (p < end && *p >= '0' && *p <= '9') {
+    /* digits past MAX_FAST_DIGITS are only counted, the value is then recomputed from text */
+    if (count < MAX_FAST_DIGITS)
+      value = value * 10 + (uint64_t)(*p - '0');
+    count++;
+    p++;
+  }
+  *mantissa = value;
+  *digits = count;
+  return p;
+}
+
+static INLINE void INLINE_ATTRIBUTE number_decode(json_value *v, uint64_t mantissa, int digits, int exponent, uint8_t flags) {
+  bool negative = (flags & JSON_NUMBER_NEGATIVE) != 0;
+  if (digits <= MAX_FAST_DIGITS) {
+    if (flags & JSON_NUMBER_INTEGER) {
+      if (!negative && mantissa <= (uint64_t)INT64_MAX) {
+        v->u.number.value.integer = (int64_t)mantissa;
+        v->flags = (uint8_t)(flags | JSON_NUMBER_DECODED);
+        return;
+      }
+      if (negative && mantissa <= (uint64_t)INT64_MAX + 1) {
+        v->u.number.value.integer = mantissa == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)mantissa;
+        v->flags = (uint8_t)(flags | JSON_NUMBER_DECODED);
+        return;
+      }
+    } else if (mantissa == 0) {
+      v->u.number.value.real = negative ? -0.0 : 0.0;
+      v->flags = (uint8_t)(flags | JSON_NUMBER_DECODED);
+      return;
+    } else if (FAST_DOUBLE_PATH && mantissa <= MAX_FAST_MANTISSA && exponent >= -MAX_FAST_EXPONENT && exponent <= MAX_FAST_EXPONENT) {
+      double value = (double)mantissa;
+      if (exponent < 0)
+        value /= power_of_ten[-exponent];
+      else
+        value *= power_of_ten[exponent];
+      v->u.number.value.real = negative ? -value : value;
+      v->flags = (uint8_t)(flags | JSON_NUMBER_DECODED);
+      return;
+    }
+  }
+  /* the exact conversion needs strtod(), which the accessors run on demand */
+  if (flags & JSON_NUMBER_INTEGER)
+    flags |= JSON_NUMBER_OVERFLOW;
+  v->flags = flags;
+}
+
+#endif
+
 static bool parse_number(const char **s, const char *end, json_value *v) {
   const char *start_p = *s;
   const char *p = *s;
+#ifdef NUMBER_DECODING
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  uint8_t flags = JSON_NUMBER_INTEGER;
+#endif
 
   if (p >= end)
     return false; /* guard before any access */
 
   if (*p == '-') {
+#ifdef NUMBER_DECODING
+    flags |= JSON_NUMBER_NEGATIVE;
+#endif
     if (++p >= end)
       return false;
   }
@@ -194,10 +603,14 @@ static bool parse_number(const char **s, const char *end, json_value *v) {
     if (++p < end && *p >= '0' && *p <= '9')
       return false;
   } else if (*p >= '1' && *p <= '9') {
+#ifdef NUMBER_DECODING
+    p = scan_digits(p, end, &mantissa, &digits);
+#else
     if (++p < end) {
       while (p < end && *p >= '0' && *p <= '9')
         p++;
     }
+#endif
   } else {
     return false;
   }
@@ -208,49 +621,269 @@ static bool parse_number(const char **s, const char *end, json_value *v) {
       return false;
     if (*p < '0' || *p > '9')
       return false;
+#ifdef NUMBER_DECODING
+    const char *fraction = p;
+    p = scan_digits(p, end, &mantissa, &digits);
+    exponent -= (int)(p - fraction);
+    flags &= (uint8_t)~JSON_NUMBER_INTEGER;
+#else
     while (++p < end && *p >= '0' && *p <= '9') { /* skip digits */
     }
+#endif
   }
 
   /* exponent part */
   if (p < end && (*p == 'e' || *p == 'E')) {
+#ifdef NUMBER_DECODING
+    bool exponent_negative = false;
+    int exponent_value = 0;
+#endif
     if (++p >= end)
       return false;
     if (*p == '+' || *p == '-') {
+#ifdef NUMBER_DECODING
+      exponent_negative = *p == '-';
+#endif
       if (++p >= end)
         return false;
     }
     if (*p < '0' || *p > '9')
       return false;
+#ifdef NUMBER_DECODING
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      if (exponent_value < MAX_EXPONENT_DIGITS_VALUE)
+        exponent_value = exponent_value * 10 + (*p - '0');
+    }
+    exponent += exponent_negative ? -exponent_value : exponent_value;
+    flags = (uint8_t)((flags & ~JSON_NUMBER_INTEGER) | JSON_NUMBER_EXPONENT);
+#else
     while (++p < end && *p >= '0' && *p <= '9') { /* skip digits */
     }
+#endif
   }
 
   v->u.number.ptr = start_p;
   v->u.number.len = p - start_p;
+#ifdef NUMBER_DECODING
+  number_decode(v, mantissa, digits, exponent, flags);
+#else
+  v->flags = 0;
+#endif
   *s = p;
   return true;
 }
 
+#if UTF8_VALIDATION
+
+#define UTF8_TOO_SHORT (1 << 0)      /* lead byte followed by a non-continuation byte */
+#define UTF8_TOO_LONG (1 << 1)       /* ASCII byte followed by a continuation byte */
+#define UTF8_OVERLONG_3 (1 << 2)     /* 11100000 100_____ */
+#define UTF8_TOO_LARGE (1 << 3)      /* code point above U+10FFFF */
+#define UTF8_SURROGATE (1 << 4)      /* 11101101 101_____ (U+D800..U+DFFF) */
+#define UTF8_OVERLONG_2 (1 << 5)     /* 1100000_ 10______ */
+#define UTF8_TOO_LARGE_1000 (1 << 6) /* 11110101+ 1000____ */
+#define UTF8_OVERLONG_4 (1 << 6)     /* 11110000 1000____ */
+#define UTF8_TWO_CONTS (1 << 7)      /* continuation byte following a continuation byte */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#if defined(__SSSE3__) || defined(UTF8_RUNTIME_SSSE3)
+#ifdef UTF8_RUNTIME_SSSE3
+#define UTF8_SSSE3_TARGET __attribute__((target("ssse3")))
+#else
+#define UTF8_SSSE3_TARGET
+#endif
+/*
+ * Vectorized UTF-8 validation (Keiser & Lemire lookup algorithm).
+ * Every adjacent byte pair is classified by three 16-entry tables indexed by
+ * the high nibble of the first byte, its low nibble and the high nibble of the
+ * second byte; a pair is invalid iff the three lookups share an error bit.
+ * Positions two and three bytes after a 3/4-byte lead must be continuations.
+ */
+static INLINE __m128i INLINE_ATTRIBUTE UTF8_SSSE3_TARGET utf8_check_block(__m128i input, __m128i prev_input) {
+  const __m128i low_nibble = _mm_set1_epi8(0x0F);
+  const __m128i byte_1_high_table = _mm_setr_epi8(
+      UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+      UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+      (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS,
+      UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+      UTF8_TOO_SHORT,
+      UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+      UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+  const __m128i byte_1_low_table = _mm_setr_epi8(
+      (char)(UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4),
+      (char)(UTF8_CARRY | UTF8_OVERLONG_2),
+      (char)UTF8_CARRY,
+      (char)UTF8_CARRY,
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+      (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000));
+  const __m128i byte_2_high_table = _mm_setr_epi8(
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+      (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4),
+      (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE),
+      (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE),
+      (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE),
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+  __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+  __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+  __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, low_nibble));
+  __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+  __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+  __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+  __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+  __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+  __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+  __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+  return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+static INLINE __m128i INLINE_ATTRIBUTE UTF8_SSSE3_TARGET utf8_incomplete(__m128i input) {
+  /* a lead byte in the last three positions still expects continuation bytes */
+  const __m128i max_value = _mm_setr_epi8(
+      (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+      (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+  return _mm_subs_epu8(input, max_value);
+}
+
+static UTF8_SSSE3_TARGET bool utf8_validate_ssse3(const char *s, size_t len) {
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + SSE2_CHUNK_SIZE <= len; i += SSE2_CHUNK_SIZE) {
+    __m128i input = _mm_loadu_si128((const __m128i *)(s + i));
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+    } else {
+      error = _mm_or_si128(error, utf8_check_block(input, prev_input));
+      prev_incomplete = utf8_incomplete(input);
+    }
+    prev_input = input;
+  }
+  if (i < len) {
+    /* zero padding is ASCII, so a sequence cut by the end of the string is reported */
+    char tail[SSE2_CHUNK_SIZE] = {0};
+    memcpy(tail, s + i, len - i);
+    __m128i input = _mm_loadu_si128((const __m128i *)tail);
+    error = _mm_or_si128(error, utf8_check_block(input, prev_input));
+    prev_incomplete = utf8_incomplete(input);
+  }
+  error = _mm_or_si128(error, prev_incomplete);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+#ifndef __SSSE3__
+static bool utf8_validate_scalar(const char *s, size_t len) {
+  const unsigned char *p = (const unsigned char *)s;
+  const unsigned char *end = p + len;
+  while (p < end) {
+    unsigned char c = *p;
+    if (c < 0x80) {
+      p++;
+      continue;
+    }
+    size_t n;
+    unsigned char lo = 0x80, hi = 0xBF; /* allowed range of the second byte */
+    if (c >= 0xC2 && c <= 0xDF) {
+      n = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+      n = 3;
+      if (c == 0xE0)
+        lo = 0xA0; /* overlong */
+      else if (c == 0xED)
+        hi = 0x9F; /* surrogate */
+    } else if (c >= 0xF0 && c <= 0xF4) {
+      n = 4;
+      if (c == 0xF0)
+        lo = 0x90; /* overlong */
+      else if (c == 0xF4)
+        hi = 0x8F; /* above U+10FFFF */
+    } else {
+      return false;
+    }
+    if ((size_t)(end - p) < n || p[1] < lo || p[1] > hi)
+      return false;
+    size_t k;
+    for (k = 2; k < n; k++) {
+      if ((p[k] & 0xC0) != 0x80)
+        return false;
+    }
+    p += n;
+  }
+  return true;
+}
+#endif
+
+static bool utf8_validate(const char *s, size_t len) {
+#if defined(__SSSE3__)
+  return utf8_validate_ssse3(s, len);
+#elif defined(UTF8_RUNTIME_SSSE3)
+  if (__builtin_cpu_supports("ssse3"))
+    return utf8_validate_ssse3(s, len);
+  return utf8_validate_scalar(s, len);
+#else
+  return utf8_validate_scalar(s, len);
+#endif
+}
+
+#endif
+
 static INLINE bool INLINE_ATTRIBUTE parse_string(const char **s, const char *end, json_value *v) {
   const char *p = *s + 1;
   v->u.string.ptr = p;
+  v->flags = 0;
 
 #ifdef __SSE2__
   const __m128i quote = _mm_set1_epi8('\"');
   const __m128i backslash = _mm_set1_epi8('\\');
+#if STRING_VALIDATION
+  /* bytes below 0x20 are the only ones left unchanged by an unsigned min with 0x1F */
+  const __m128i control = _mm_set1_epi8(MIN_PRINTABLE_ASCII - 1);
+#endif
+#if UTF8_VALIDATION
+  __m128i non_ascii = _mm_setzero_si128();
+#endif
+#endif
+#if UTF8_VALIDATION
+  unsigned char non_ascii_tail = 0;
+#endif
 
+continue_search:
+#ifdef __SSE2__
   while (p + (SSE2_CHUNK_SIZE - 1) < end) {
     __m128i chunk = _mm_loadu_si128((const __m128i *)p);
     __m128i cmp_quote = _mm_cmpeq_epi8(chunk, quote);
     __m128i cmp_backslash = _mm_cmpeq_epi8(chunk, backslash);
-    int mask = _mm_movemask_epi8(_mm_or_si128(cmp_quote, cmp_backslash));
-
+    __m128i stop = _mm_or_si128(cmp_quote, cmp_backslash);
+#if STRING_VALIDATION
+    __m128i cmp_control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk);
+    stop = _mm_or_si128(stop, cmp_control);
+#endif
+    int mask = _mm_movemask_epi8(stop);
     if (mask != 0) {
       int offset = __builtin_ctz(mask);
+#if UTF8_VALIDATION
+      /* bytes past the quote or backslash belong to the rest of the document */
+      if (_mm_movemask_epi8(chunk) & ((1 << offset) - 1))
+        non_ascii_tail |= MAX_ASCII;
+#endif
       p += offset;
       goto found;
     }
+#if UTF8_VALIDATION
+    non_ascii = _mm_or_si128(non_ascii, chunk);
+#endif
     p += SSE2_CHUNK_SIZE;
   }
 #endif
@@ -258,44 +891,33 @@ static INLINE bool INLINE_ATTRIBUTE parse_string(const char **s, const char *end
     if (*p == '\"' || *p == '\\') {
       goto found;
     }
+#if STRING_VALIDATION
+    if ((unsigned char)*p < MIN_PRINTABLE_ASCII)
+      return false;
+#endif
+#if UTF8_VALIDATION
+    non_ascii_tail |= (unsigned char)*p;
+#endif
     p++;
   }
   return false;
 found:
   if (*p == '"') {
-#if STRING_VALIDATION
-    const char *chk = v->u.string.ptr;
-    size_t chk_len = (size_t)(p - chk);
+#if UTF8_VALIDATION
+    /* only strings that contain non-ASCII bytes are read a second time */
 #ifdef __SSE2__
-    size_t i = 0;
-    const __m128i threshold = _mm_set1_epi8(MIN_PRINTABLE_ASCII);
-    const __m128i high_bit = _mm_set1_epi8(MAX_PRINTABLE_ASCII);
-    const __m128i zero = _mm_setzero_si128();
-    for (; i + 15 < chk_len; i += 16) {
-      __m128i chunk = _mm_loadu_si128((const __m128i *)(chk + i));
-      __m128i is_ascii = _mm_cmpeq_epi8(_mm_and_si128(chunk, high_bit), zero);
-      __m128i is_control = _mm_cmplt_epi8(chunk, threshold);
-      __m128i bad = _mm_and_si128(is_ascii, is_control);
-      if (_mm_movemask_epi8(bad) != 0)
-        return false;
-    }
-    for (; i < chk_len; ++i) {
-      if ((unsigned char)chk[i] < 0x20)
-        return false;
-    }
-#else
-    size_t i;
-    for (i = 0; i < chk_len; ++i) {
-      if ((unsigned char)chk[i] < 0x20)
-        return false;
-    }
+    if (_mm_movemask_epi8(non_ascii) != 0)
+      non_ascii_tail |= MAX_ASCII;
 #endif
+    if ((non_ascii_tail & MAX_ASCII) && !utf8_validate(v->u.string.ptr, (size_t)(p - v->u.string.ptr)))
+      return false;
 #endif
     v->u.string.len = p - *s - 1;
     *s = p + 1;
     return true;
   }
   if (*p == '\\') {
+    v->flags |= JSON_STRING_HAS_ESCAPES;
     p++;
     if (p >= end)
       return false;
@@ -311,7 +933,7 @@ found:
       p++;
       break;
     case 'u':
-      if (p + (HEX_LOOKUP - 1) > end)
+      if (p + (HEX_LOOKUP - 1) >= end)
         return false;
       if (hex_lookup[(unsigned char)p[1]] < 0 ||
           hex_lookup[(unsigned char)p[2]] < 0 ||
@@ -326,40 +948,146 @@ found:
     goto continue_search;
   }
 
+  /* control character, only reachable with STRING_VALIDATION */
   return false;
+}
 
-continue_search:
+static INLINE int32_t INLINE_ATTRIBUTE hex4(const char *p) {
+  int32_t a = hex_lookup[(unsigned char)p[0]];
+  int32_t b = hex_lookup[(unsigned char)p[1]];
+  int32_t c = hex_lookup[(unsigned char)p[2]];
+  int32_t d = hex_lookup[(unsigned char)p[3]];
+  if ((a | b | c | d) < 0)
+    return -1;
+  return (a << 12) | (b << 8) | (c << 4) | d;
+}
+
+static INLINE char *INLINE_ATTRIBUTE utf8_encode(char *dst, uint32_t cp) {
+  if (cp < 0x80) {
+    *dst++ = (char)cp;
+  } else if (cp < 0x800) {
+    *dst++ = (char)(0xC0 | (cp >> 6));
+    *dst++ = (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *dst++ = (char)(0xE0 | (cp >> 12));
+    *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+    *dst++ = (char)(0x80 | (cp & 0x3F));
+  } else {
+    *dst++ = (char)(0xF0 | (cp >> 18));
+    *dst++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+    *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+    *dst++ = (char)(0x80 | (cp & 0x3F));
+  }
+  return dst;
+}
+
+/* dst may equal p: every escape is at least as long as its decoded form and
+   each chunk is loaded before it is stored */
+static size_t string_unescape(const char *p, const char *end, char *dst) {
+  char *start = dst;
 #ifdef __SSE2__
-  while (p + (SSE2_CHUNK_SIZE - 1) < end) {
-    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
-    __m128i cmp_quote = _mm_cmpeq_epi8(chunk, quote);
-    __m128i cmp_backslash = _mm_cmpeq_epi8(chunk, backslash);
-    int mask = _mm_movemask_epi8(_mm_or_si128(cmp_quote, cmp_backslash));
-    if (mask != 0) {
-      int offset = __builtin_ctz(mask);
-      p += offset;
-      goto found;
+  const __m128i backslash = _mm_set1_epi8('\\');
+#endif
+  while (true) {
+#ifdef __SSE2__
+    while (p + (SSE2_CHUNK_SIZE - 1) < end) {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash));
+      if (mask != 0) {
+        int offset = __builtin_ctz(mask);
+        memmove(dst, p, (size_t)offset);
+        dst += offset;
+        p += offset;
+        goto escape;
+      }
+      _mm_storeu_si128((__m128i *)dst, chunk);
+      dst += SSE2_CHUNK_SIZE;
+      p += SSE2_CHUNK_SIZE;
     }
-    p += SSE2_CHUNK_SIZE;
-  }
 #endif
-  while (p < end) {
-    if (*p == '\"' || *p == '\\') {
-      goto found;
+    while (p < end && *p != '\\')
+      *dst++ = *p++;
+    if (p == end)
+      return (size_t)(dst - start);
+#ifdef __SSE2__
+  escape:
+#endif
+    if (++p == end)
+      return JSON_DECODE_ERROR;
+    switch (*p++) {
+    case '\"':
+      *dst++ = '\"';
+      break;
+    case '\\':
+      *dst++ = '\\';
+      break;
+    case '/':
+      *dst++ = '/';
+      break;
+    case 'b':
+      *dst++ = '\b';
+      break;
+    case 'f':
+      *dst++ = '\f';
+      break;
+    case 'n':
+      *dst++ = '\n';
+      break;
+    case 'r':
+      *dst++ = '\r';
+      break;
+    case 't':
+      *dst++ = '\t';
+      break;
+    case 'u': {
+      int32_t cp;
+      if (end - p < HEX_LOOKUP - 1 || (cp = hex4(p)) < 0)
+        return JSON_DECODE_ERROR;
+      p += HEX_LOOKUP - 1;
+      if (cp >= 0xD800 && cp <= 0xDBFF) {
+        int32_t low;
+        if (end - p >= HEX_LOOKUP + 1 && p[0] == '\\' && p[1] == 'u' && (low = hex4(p + 2)) >= 0xDC00 && low <= 0xDFFF) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          p += HEX_LOOKUP + 1;
+        } else {
+          cp = UNICODE_REPLACEMENT;
+        }
+      } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        cp = UNICODE_REPLACEMENT;
+      }
+      dst = utf8_encode(dst, (uint32_t)cp);
+      break;
+    }
+    default:
+      return JSON_DECODE_ERROR;
     }
-    p++;
   }
-  return false;
+}
+
+static INLINE bool INLINE_ATTRIBUTE parse_string_in_situ(const char **s, const char *end, json_value *v) {
+  size_t len;
+  if (!parse_string(s, end, v))
+    return false;
+  if (!(v->flags & JSON_STRING_HAS_ESCAPES))
+    return true;
+  /* the string was just scanned and is still in cache; the buffer is writable by contract */
+  len = string_unescape(v->u.string.ptr, v->u.string.ptr + v->u.string.len, (char *)v->u.string.ptr);
+  if (len == JSON_DECODE_ERROR)
+    return false;
+  v->u.string.len = len;
+  v->flags &= (uint8_t)~JSON_STRING_HAS_ESCAPES;
+  return true;
 }
 
 static INLINE bool INLINE_ATTRIBUTE parse_array(const char **s, const char *end, json_value *v) {
   while (true) {
     if (!skip_whitespace(s, end))
       return false;
-    if (next_array_index == JSON_VALUE_POOL_SIZE) {
+    if (context->next_array_index == JSON_VALUE_POOL_SIZE) {
       return false;
     }
-    json_array_node *array_node = &json_array_node_pool[next_array_index++];
+    json_array_node *array_node = &context->array_nodes[context->next_array_index++];
+    array_node->next = NULL;
     do {
       if (v->u.array.items == NULL) {
         v->u.array.items = array_node;
@@ -425,12 +1153,14 @@ static INLINE bool INLINE_ATTRIBUTE parse_object(const char **s, const char *end
       object_items = next;
     }
     if (object_items == NULL) {
-      if (next_object_index == JSON_VALUE_POOL_SIZE) {
+      if (context->next_object_index == JSON_VALUE_POOL_SIZE) {
         return false;
       }
-      object_node = &json_object_node_pool[next_object_index++];
+      object_node = &context->object_nodes[context->next_object_index++];
+      object_node->next = NULL;
       object_node->item.key.ptr = key.u.string.ptr;
       object_node->item.key.len = key.u.string.len;
+      object_node->item.value.key_flags = key.flags;
       do {
         if (v->u.object.items == NULL) {
           v->u.object.items = object_node;
@@ -470,7 +1200,9 @@ static INLINE bool INLINE_ATTRIBUTE parse_object(const char **s, const char *end
 }
 
 static bool parse_json(const char **s, const char *end, json_value *v) {
-  if (**s == '{') {
+  uint8_t kind = value_lookup[(unsigned char)**s];
+  switch (kind) {
+  case VALUE_OBJECT:
     v->type = J_OBJECT;
     v->u.object.items = NULL;
     v->u.object.last = NULL;
@@ -482,8 +1214,7 @@ static bool parse_json(const char **s, const char *end, json_value *v) {
       return true;
     }
     return parse_object(s, end, v);
-  }
-  if (**s == '[') {
+  case VALUE_ARRAY:
     v->type = J_ARRAY;
     v->u.array.items = NULL;
     v->u.array.last = NULL;
@@ -497,37 +1228,21 @@ static bool parse_json(const char **s, const char *end, json_value *v) {
       return true;
     }
     return parse_array(s, end, v);
-  }
-  if (**s == '\"') {
+  case VALUE_STRING:
     v->type = J_STRING;
     return parse_string(s, end, v);
-  }
-  if (**s == 'n' && *s + 3 < end && *(*s + 1) == 'u' && *(*s + 2) == 'l' && *(*s + 3) == 'l') {
-    v->type = J_NULL;
-    v->u.string.ptr = *s;
-    v->u.string.len = 4;
-    *s += 4;
+  case VALUE_TRUE:
+  case VALUE_FALSE:
+  case VALUE_NULL:
+    return parse_literal(s, end, v, kind);
+  case VALUE_NUMBER:
+    if (!parse_number(s, end, v))
+      return false;
+    v->type = J_NUMBER;
     return true;
+  default:
+    return false;
   }
-  if (**s == 't' && *s + 3 < end && *(*s + 1) == 'r' && *(*s + 2) == 'u' && *(*s + 3) == 'e') {
-    v->type = J_BOOLEAN;
-    v->u.boolean.ptr = *s;
-    v->u.boolean.len = JSON_TRUE_LEN;
-    *s += JSON_TRUE_LEN;
-    return true;
-  }
-  if (**s == 'f' && *s + 4 < end && *(*s + 1) == 'a' && *(*s + 2) == 'l' && *(*s + 3) == 's' && *(*s + 4) == 'e') {
-    v->type = J_BOOLEAN;
-    v->u.boolean.ptr = *s;
-    v->u.boolean.len = JSON_FALSE_LEN;
-    *s += JSON_FALSE_LEN;
-    return true;
-  }
-  if (parse_number(s, end, v)) {
-    v->type = J_NUMBER;
-    return true;
-  }
-  return false;
 }
 
 /* --- pretty-print helpers --- */
@@ -880,410 +1595,2102 @@ static INLINE bool INLINE_ATTRIBUTE json_object_equal(const json_value *a, const
 
 /* --- public API --- */
 
-INLINE json_error INLINE_ATTRIBUTE json_validate(const char *s, const char *end) {
-  size_t len = end - s;
-  if (s == NULL || len == 0 || *s == '\0' || !(*s == '{' || *s == '[')) {
-    return E_INVALID_JSON;
-  }
-  json_value *stack[JSON_STACK_SIZE];
-  json_value v;
+/* the validator proper; on failure *at is the offending byte, the start of the offending token */
+static INLINE json_error INLINE_ATTRIBUTE validate(const char *s, const char *end, const char **at) {
+  /* one bit per open container, set for objects; the node pools are never touched */
+  uint64_t objects[BIT_STACK_WORDS];
   int top = -1;
-#ifdef ZERO_MEMORY
-  /* memset(&v, 0, sizeof(json_value)); */
-  json_value_zero(&v);
-#endif
-  json_value *current = &v;
+  bool first = false;
+  json_value v;
+#define VALIDATE_FAIL(position, code) \
+  do {                                \
+    *at = (position);                 \
+    return (code);                    \
+  } while (0)
+  if (s == NULL || s >= end || !(*s == '{' || *s == '[')) {
+    VALIDATE_FAIL(s, E_INVALID_JSON);
+  }
   while (true) {
+    const char *token;
+    bool object;
+    uint8_t kind;
     if (s == end)
-      break;
+      VALIDATE_FAIL(s, E_INVALID_JSON);
     if (!skip_whitespace(&s, end))
-      return E_INVALID_JSON;
-    if (current) {
-      do {
-        if (*s == '{') {
-          current->type = J_OBJECT;
-          current->u.object.items = NULL;
-          current->u.object.last = NULL;
-          if (++top >= JSON_STACK_SIZE)
-            return E_NO_MEMORY_OBJECT;
-          s++;
-          stack[top] = current;
-          current = NULL;
-          break;
-        }
-        if (*s == '[') {
-          current->type = J_ARRAY;
-          current->u.array.items = NULL;
-          current->u.array.last = NULL;
-          s++;
-          if (++top >= JSON_STACK_SIZE)
-            return E_NO_MEMORY_ARRAY;
-          stack[top] = current;
-          current = NULL;
-          break;
-        }
-        if (*s == '\"') {
-          current->type = J_STRING;
-          if (parse_string(&s, end, current)) {
-            current = NULL;
-            break;
-          }
-          return E_EXPECTED_STRING;
-        }
-        if (*s == 't') {
-          if (s + 3 < end && *(s + 1) == 'r' && *(s + 2) == 'u' && *(s + 3) == 'e') {
-            current->type = J_BOOLEAN;
-            current->u.boolean.ptr = s;
-            current->u.boolean.len = JSON_TRUE_LEN;
-            s += 4;
-            current = NULL;
-            break;
-          }
-          return E_EXPECTED_CONSTANT;
-        }
-        if (*s == 'f') {
-          if (s + 4 < end && *(s + 1) == 'a' && *(s + 2) == 'l' && *(s + 3) == 's' && *(s + 4) == 'e') {
-            current->type = J_BOOLEAN;
-            current->u.boolean.ptr = s;
-            current->u.boolean.len = JSON_FALSE_LEN;
-            s += JSON_FALSE_LEN;
-            current = NULL;
-            break;
-          }
-          return E_EXPECTED_CONSTANT;
-        }
-        if (*s == 'n') {
-          if (s + 3 < end && *(s + 1) == 'u' && *(s + 2) == 'l' && *(s + 3) == 'l') {
-            current->type = J_NULL;
-            s += 4;
-            current = NULL;
-            break;
-          }
-          return E_EXPECTED_CONSTANT;
-        }
-        if (*s == '-' || *s == '0' || (*s >= '1' && *s <= '9')) {
-          if (!parse_number(&s, end, current)) {
-            return E_EXPECTED_NUMBER;
-          }
-          current->type = J_NUMBER;
-          current = NULL;
-          break;
-        }
-        return E_INVALID_JSON;
-      } while (0);
-      if (!current) {
-        continue;
-      }
-    }
-    if (top == -1) {
+      VALIDATE_FAIL(s, E_INVALID_JSON);
+    token = s;
+    kind = value_lookup[(unsigned char)*s];
+    switch (kind) {
+    case VALUE_OBJECT:
+      if (++top >= JSON_STACK_SIZE)
+        VALIDATE_FAIL(token, E_NO_MEMORY_OBJECT);
+      objects[top >> 6] |= (uint64_t)1 << (top & 63);
+      s++;
+      first = true;
+      break;
+    case VALUE_ARRAY:
+      if (++top >= JSON_STACK_SIZE)
+        VALIDATE_FAIL(token, E_NO_MEMORY_ARRAY);
+      objects[top >> 6] &= ~((uint64_t)1 << (top & 63));
+      s++;
+      first = true;
+      break;
+    case VALUE_STRING:
+      if (!parse_string(&s, end, &v))
+        VALIDATE_FAIL(token, E_EXPECTED_STRING);
+      break;
+    case VALUE_TRUE:
+    case VALUE_FALSE:
+    case VALUE_NULL:
+      if (!parse_literal(&s, end, &v, kind))
+        VALIDATE_FAIL(token, E_EXPECTED_CONSTANT);
+      break;
+    case VALUE_NUMBER:
+      if (!parse_number(&s, end, &v))
+        VALIDATE_FAIL(token, E_EXPECTED_NUMBER);
       break;
+    default:
+      VALIDATE_FAIL(token, E_INVALID_JSON);
     }
-    current = stack[top];
-    if (current->type == J_OBJECT) {
-      if (*s == '}') {
-        top--;
-        s++;
-        if (s == end) {
-          break;
-        }
-        current = NULL;
-        continue;
+    /* close finished containers, then move to the next element */
+    while (true) {
+      if (top == -1) {
+        if (s != end)
+          VALIDATE_FAIL(s, E_INVALID_JSON);
+        return E_OK;
       }
-      if (current->u.object.items != NULL) {
-        if (*s != ',') {
-          return E_EXPECTED_OBJECT;
-        }
+      if (s == end || !skip_whitespace(&s, end))
+        VALIDATE_FAIL(s, E_INVALID_JSON);
+      object = ((objects[top >> 6] >> (top & 63)) & 1) != 0;
+      if (*s == (object ? '}' : ']')) {
         s++;
-        if (!skip_whitespace(&s, end)) {
-          return E_INVALID_JSON;
-        }
-        if (*s == '}') {
-          return E_EXPECTED_OBJECT_ELEMENT;
-        }
-      }
-      if (*s != '\"') {
-        return E_EXPECTED_OBJECT_KEY;
-      }
-      json_value key;
-      if (!parse_string(&s, end, &key))
-        return E_EXPECTED_OBJECT_KEY;
-      if (!skip_whitespace(&s, end)) {
-        return E_INVALID_JSON;
-      }
-      if (*s != ':') {
-        return E_EXPECTED_OBJECT_VALUE;
-      }
-      s++;
-      if (!skip_whitespace(&s, end)) {
-        return E_INVALID_JSON;
-      }
-      if (next_object_index == JSON_VALUE_POOL_SIZE) {
-        return E_NO_MEMORY_OBJECT;
-      }
-      json_object_node *node = &json_object_node_pool[next_object_index++];
-      node->item.key = key.u.string;
-      if (current->u.object.items == NULL) {
-        current->u.object.items = node;
-      } else {
-        current->u.object.last->next = node;
-      }
-      current->u.object.last = node;
-      current = &node->item.value;
-      continue;
-    }
-    if (current->type == J_ARRAY) {
-      if (*s == ']') {
         top--;
-        s++;
-        if (s == end) {
-          break;
-        }
-        current = NULL;
+        first = false;
         continue;
       }
-      if (current->u.array.items != NULL) {
-        if (*s != ',') {
-          return E_EXPECTED_ARRAY;
-        }
+      if (!first) {
+        if (*s != ',')
+          VALIDATE_FAIL(s, object ? E_EXPECTED_OBJECT : E_EXPECTED_ARRAY);
         s++;
-        if (!skip_whitespace(&s, end)) {
-          return E_INVALID_JSON;
-        }
-        if (*s == ']') {
-          return E_EXPECTED_ARRAY_ELEMENT;
-        }
+        if (!skip_whitespace(&s, end))
+          VALIDATE_FAIL(s, E_INVALID_JSON);
+        if (*s == (object ? '}' : ']'))
+          VALIDATE_FAIL(s, object ? E_EXPECTED_OBJECT_ELEMENT : E_EXPECTED_ARRAY_ELEMENT);
       }
-      if (next_array_index == JSON_VALUE_POOL_SIZE) {
-        return E_NO_MEMORY_ARRAY;
-      }
-      json_array_node *node = &json_array_node_pool[next_array_index++];
-      if (current->u.array.items == NULL) {
-        current->u.array.items = node;
-      } else {
-        current->u.array.last->next = node;
+      first = false;
+      if (object) {
+        token = s;
+        if (*s != '\"' || !parse_string(&s, end, &v))
+          VALIDATE_FAIL(token, E_EXPECTED_OBJECT_KEY);
+        if (!skip_whitespace(&s, end))
+          VALIDATE_FAIL(s, E_INVALID_JSON);
+        if (*s != ':')
+          VALIDATE_FAIL(s, E_EXPECTED_OBJECT_VALUE);
+        s++;
+        if (!skip_whitespace(&s, end))
+          VALIDATE_FAIL(s, E_INVALID_JSON);
       }
-      current->u.array.last = node;
-      current = &node->item;
-      continue;
+      break;
     }
-    if (current) {
-      return E_INVALID_JSON;
+  }
+#undef VALIDATE_FAIL
+}
+
+INLINE json_error INLINE_ATTRIBUTE json_validate(const char *s, const char *end) {
+  const char *at;
+  return validate(s, end, &at);
+}
+
+/* 1-based line and byte column of result->offset; runs only after a failure */
+static void locate_error(const char *s, json_result *result) {
+  const char *p = s;
+  const char *at = s + result->offset;
+  const char *line_start = s;
+  size_t lines = 1;
+#ifdef __SSE2__
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (p + (SSE2_CHUNK_SIZE - 1) < at) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), newline));
+    if (mask != 0) {
+      lines += (size_t)__builtin_popcount(mask);
+      line_start = p + (31 - __builtin_clz(mask)) + 1;
     }
+    p += SSE2_CHUNK_SIZE;
   }
-  if (s == end && top == -1) {
-    return E_OK;
+#endif
+  for (; p < at; p++) {
+    if (*p == '\n') {
+      lines++;
+      line_start = p + 1;
+    }
   }
-  return E_INVALID_JSON;
+  result->line = lines;
+  result->column = (size_t)(at - line_start) + 1;
 }
 
-INLINE bool INLINE_ATTRIBUTE json_parse_iterative(const char *s, const char *end, json_value *root) {
-  size_t len = end - s;
-  if (s == NULL || len == 0 || *s == '\0')
-    return false;
-  if (*s != '{' && *s != '[') {
+static void report_error(const char *s, json_error error, const char *at, json_result *result) {
+  result->error = error;
+  result->offset = s ? (size_t)(at - s) : 0;
+  locate_error(s, result);
+}
+
+json_error json_validate_located(const char *s, const char *end, json_result *result) {
+  const char *at;
+  json_error error = validate(s, end, &at);
+  memset(result, 0, sizeof(json_result));
+  if (error != E_OK)
+    report_error(s, error, at, result);
+  return error;
+}
+
+/* a function with a computed goto can be neither inlined nor cloned, so the
+   parser is stamped out once per mode instead of taking the mode at run time */
+#define PARSE_ITERATIVE_NAME parse_iterative
+#define PARSE_ITERATIVE_MODE 0
+#include "json_iterative.inc"
+
+#define PARSE_ITERATIVE_NAME parse_iterative_in_situ
+#define PARSE_ITERATIVE_MODE PARSE_IN_SITU
+#include "json_iterative.inc"
+
+#define PARSE_ITERATIVE_NAME parse_iterative_padded
+#define PARSE_ITERATIVE_MODE PARSE_PADDED
+#include "json_iterative.inc"
+
+bool json_parse_iterative(const char *s, const char *end, json_value *root) {
+  return parse_iterative(s, end, root, NULL);
+}
+
+bool json_parse_in_situ(char *s, const char *end, json_value *root) {
+  return parse_iterative_in_situ(s, end, root, NULL);
+}
+
+bool json_parse_padded(const char *s, const char *end, json_value *root) {
+  size_t i;
+  if (s == NULL || end == NULL)
     return false;
+  for (i = 0; i < JSON_PADDING; i++) {
+    if (end[i] != '\0')
+      return false;
+  }
+  return parse_iterative_padded(s, end, root, NULL);
+}
+
+bool json_parse_located(const char *s, const char *end, json_value *root, json_result *result) {
+  if (parse_iterative(s, end, root, NULL)) {
+    memset(result, 0, sizeof(json_result));
+    return true;
   }
-  json_value *stack[JSON_STACK_SIZE];
+  /* cold path: the validator finds what the parser gave up on */
+  const char *at = s;
+  json_error error = validate(s, end, &at);
+  if (error == E_OK) {
+    /* well-formed input the parser could not hold: the node pools or the depth stack ran out */
+    error = context->next_object_index == JSON_VALUE_POOL_SIZE ? E_NO_MEMORY_OBJECT : E_NO_MEMORY_ARRAY;
+    at = s;
+  }
+  report_error(s, error, at, result);
+  return false;
+}
+
+char *json_padded_buffer(const char *s, size_t len) {
+  char *buffer = (char *)malloc(len + JSON_PADDING);
+  if (!buffer)
+    return NULL;
+  if (len > 0)
+    memcpy(buffer, s, len);
+  memset(buffer + len, 0, JSON_PADDING);
+  return buffer;
+}
+
+/* --- event parser --- */
+
+bool json_parse_events(const char *s, const char *end, const json_handler *handler, void *user) {
+  uint64_t objects[BIT_STACK_WORDS];
   int top = -1;
-  json_value *current = root;
+  bool first = false;
+  json_value v;
+  if (s == NULL || end == NULL || handler == NULL || s >= end || (*s != '{' && *s != '['))
+    return false;
   while (true) {
-    if (s == end)
-      break;
+    uint8_t kind;
     if (!skip_whitespace(&s, end))
       return false;
-    if (current) {
-      switch (*s) {
-      case '{':
-        current->type = J_OBJECT;
-        current->u.object.items = NULL;
-        current->u.object.last = NULL;
-        s++;
-        if (++top >= JSON_STACK_SIZE)
-          return false;
-        stack[top] = current;
-        current = NULL;
-        break;
-      case '[':
-        current->type = J_ARRAY;
-        current->u.array.items = NULL;
-        current->u.array.last = NULL;
-        s++;
-        if (++top >= JSON_STACK_SIZE)
-          return false;
-        stack[top] = current;
-        current = NULL;
-        break;
-      case '\"':
-        current->type = J_STRING;
-        if (!parse_string(&s, end, current))
-          return false;
-        current = NULL;
-        break;
-      case 't':
-        if ((s + 3) < end && *(s + 1) == 'r' && *(s + 2) == 'u' && *(s + 3) == 'e') {
-          current->type = J_BOOLEAN;
-          current->u.boolean.ptr = s;
-          current->u.boolean.len = 4;
-          s += 4;
-          current = NULL;
-        } else {
-          return false;
-        }
-        break;
-      case 'f':
-        if ((s + 4) < end && *(s + 1) == 'a' && *(s + 2) == 'l' && *(s + 3) == 's' && *(s + 4) == 'e') {
-          current->type = J_BOOLEAN;
-          current->u.boolean.ptr = s;
-          current->u.boolean.len = JSON_FALSE_LEN;
-          s += JSON_FALSE_LEN;
-          current = NULL;
-        } else {
-          return false;
-        }
-        break;
-      case 'n':
-        if ((s + 3) < end && *(s + 1) == 'u' && *(s + 2) == 'l' && *(s + 3) == 'l') {
-          current->type = J_NULL;
-          s += 4;
-          current = NULL;
-        } else {
-          return false;
-        }
-        break;
-      default:
-        if (parse_number(&s, end, current)) {
-          current->type = J_NUMBER;
-          current = NULL;
-        } else {
-          return false;
-        }
-      }
-      continue;
-    }
-    if (top == -1) {
+    kind = value_lookup[(unsigned char)*s];
+    switch (kind) {
+    case VALUE_OBJECT:
+      if (++top >= JSON_STACK_SIZE)
+        return false;
+      objects[top >> 6] |= (uint64_t)1 << (top & 63);
+      s++;
+      if (handler->on_object_begin && !handler->on_object_begin(user))
+        return false;
+      first = true;
       break;
-    }
-    current = stack[top];
-    if (current->type == J_OBJECT) {
-      if (*s == '}') {
-        s++;
-        top--;
-        current = NULL;
-        continue;
-      }
-      if (current->u.object.items != NULL) {
-        if (*s == ',') {
-          s++;
-          if (!skip_whitespace(&s, end)) {
-            return false;
-          }
-        } else {
-          return false;
-        }
-      }
-      if (*s != '\"')
+    case VALUE_ARRAY:
+      if (++top >= JSON_STACK_SIZE)
         return false;
-      json_value key;
-      if (!parse_string(&s, end, &key))
+      objects[top >> 6] &= ~((uint64_t)1 << (top & 63));
+      s++;
+      if (handler->on_array_begin && !handler->on_array_begin(user))
         return false;
-      if (!skip_whitespace(&s, end)) {
+      first = true;
+      break;
+    case VALUE_STRING:
+      v.type = J_STRING;
+      if (!parse_string(&s, end, &v))
         return false;
-      }
-      if (*s != ':')
+      if (handler->on_string && !handler->on_string(&v, user))
         return false;
-      s++;
-      if (next_object_index == JSON_VALUE_POOL_SIZE) {
+      break;
+    case VALUE_TRUE:
+    case VALUE_FALSE:
+      if (!parse_literal(&s, end, &v, kind))
         return false;
-      }
-      json_object_node *node = &json_object_node_pool[next_object_index++];
-      node->item.key = key.u.string;
-      if (current->u.object.items == NULL) {
-        current->u.object.items = node;
-      } else {
-        current->u.object.last->next = node;
-      }
-      current->u.object.last = node;
-      current = &node->item.value;
-    } else if (current->type == J_ARRAY) {
-      if (*s == ']') {
+      if (handler->on_boolean && !handler->on_boolean(kind == VALUE_TRUE, user))
+        return false;
+      break;
+    case VALUE_NULL:
+      if (!parse_literal(&s, end, &v, kind))
+        return false;
+      if (handler->on_null && !handler->on_null(user))
+        return false;
+      break;
+    case VALUE_NUMBER:
+      if (!parse_number(&s, end, &v))
+        return false;
+      v.type = J_NUMBER;
+      if (handler->on_number && !handler->on_number(&v, user))
+        return false;
+      break;
+    default:
+      return false;
+    }
+    /* close finished containers, then move to the next element */
+    while (true) {
+      bool object;
+      if (top == -1)
+        return s == end;
+      if (!skip_whitespace(&s, end))
+        return false;
+      object = ((objects[top >> 6] >> (top & 63)) & 1) != 0;
+      if (*s == (object ? '}' : ']')) {
         s++;
         top--;
-        current = NULL;
+        first = false;
+        if (object ? (handler->on_object_end && !handler->on_object_end(user)) : (handler->on_array_end && !handler->on_array_end(user)))
+          return false;
         continue;
       }
-      if (current->u.array.items != NULL) {
-        if (*s == ',') {
-          s++;
-        } else {
+      if (!first) {
+        if (*s != ',')
+          return false;
+        s++;
+        if (!skip_whitespace(&s, end))
           return false;
-        }
-      }
-      if (next_array_index == JSON_VALUE_POOL_SIZE) {
-        return E_NO_MEMORY_ARRAY;
       }
-      json_array_node *node = &json_array_node_pool[next_array_index++];
-      if (current->u.array.items == NULL) {
-        current->u.array.items = node;
-      } else {
-        current->u.array.last->next = node;
+      first = false;
+      if (object) {
+        json_value key;
+        if (*s != '\"')
+          return false;
+        key.type = J_STRING;
+        if (!parse_string(&s, end, &key))
+          return false;
+        if (!skip_whitespace(&s, end) || *s != ':')
+          return false;
+        s++;
+        if (handler->on_key && !handler->on_key(&key, user))
+          return false;
       }
-      current->u.array.last = node;
-      current = &node->item;
+      break;
     }
   }
-  return s == end && top == -1;
 }
 
-INLINE bool INLINE_ATTRIBUTE json_parse(const char *s, const char *end, json_value *root) {
-  size_t len = end - s;
-  if (s == NULL || len == 0 || *s == '\0')
-    return false;
-  if (*s != '{' && *s != '[') {
-    return false;
+/* --- on-demand cursor --- */
+
+#define CURSOR_IS_OBJECT(c, level) ((((c)->objects[(level) >> 6] >> ((level) & 63)) & 1) != 0)
+
+/* returns the position after the closing quote of the string starting at p, or NULL */
+/* first quote or backslash at or after p, or end */
+static INLINE const char *INLINE_ATTRIBUTE find_quote_or_backslash(const char *p, const char *end) {
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (p + (SSE2_CHUNK_SIZE - 1) < end) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += SSE2_CHUNK_SIZE;
   }
-  return parse_json(&s, end, root) && s == end;
+#endif
+  while (p < end && *p != '"' && *p != '\\')
+    p++;
+  return p;
 }
 
-bool json_equal(const json_value *a, const json_value *b) {
-  if (a == b)
-    return true;
-  if (!a || !b)
-    return false;
-  if (a->type != b->type)
-    return false;
-  switch (a->type) {
-  case J_NULL:
-    return true;
-  case J_BOOLEAN:
-    return a->u.boolean.len == b->u.boolean.len && strncmp(a->u.boolean.ptr, b->u.boolean.ptr, a->u.boolean.len) == 0;
-  case J_NUMBER: {
-    return a->u.number.len == b->u.number.len && strncmp(a->u.number.ptr, b->u.number.ptr, a->u.number.len) == 0;
-  }
-  case J_STRING:
-    if (a->u.string.ptr == NULL && b->u.string.ptr == NULL)
-      return true;
-    return a->u.string.ptr && b->u.string.ptr && a->u.string.len == b->u.string.len && strncmp(a->u.string.ptr, b->u.string.ptr, a->u.string.len) == 0;
-  case J_ARRAY:
-    return json_array_equal(a, b);
-  case J_OBJECT:
-    return json_object_equal(a, b);
-  default:
-    return false;
+static INLINE const char *INLINE_ATTRIBUTE skip_string_raw(const char *p, const char *end) {
+  p++;
+  while (p < end) {
+    p = find_quote_or_backslash(p, end);
+    if (p >= end)
+      break;
+    if (*p == '"')
+      return p + 1;
+    p += 2;
   }
+  return NULL;
 }
 
-INLINE void INLINE_ATTRIBUTE json_reset(void) {
-  next_array_index = 0;
-  next_object_index = 0;
+/* p is inside `depth` open containers; returns the position after the last of their closing brackets, or NULL */
+static const char *skip_containers(const char *p, const char *end, size_t depth) {
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+#endif
+  while (p < end) {
+#ifdef __SSE2__
+    /* '[' and ']' differ from '{' and '}' only in bit 0x20; blocks without a
+       quote that cannot close the outermost container are counted whole */
+    while (p + (SSE2_CHUNK_SIZE - 1) < end) {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+      __m128i folded = _mm_or_si128(chunk, case_bit);
+      int quotes = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote));
+      int opens = _mm_movemask_epi8(_mm_cmpeq_epi8(folded, open));
+      int closes = _mm_movemask_epi8(_mm_cmpeq_epi8(folded, close));
+      if (quotes == 0 && (size_t)__builtin_popcount(closes) < depth) {
+        depth += (size_t)__builtin_popcount(opens);
+        depth -= (size_t)__builtin_popcount(closes);
+        p += SSE2_CHUNK_SIZE;
+        continue;
+      }
+      p += __builtin_ctz(quotes | opens | closes);
+      break;
+    }
+    if (p >= end)
+      break;
+#endif
+    switch (*p) {
+    case '"':
+      p = skip_string_raw(p, end);
+      if (!p)
+        return NULL;
+      continue;
+    case '[':
+    case '{':
+      depth++;
+      break;
+    case ']':
+    case '}':
+      if (--depth == 0)
+        return p + 1;
+      break;
+    default:
+      break;
+    }
+    p++;
+  }
+  return NULL;
 }
 
-INLINE void INLINE_ATTRIBUTE json_cleanup(void) {
-  memset(json_array_node_pool, 0, JSON_VALUE_POOL_SIZE * sizeof(json_array_node));
-  memset(json_object_node_pool, 0, JSON_VALUE_POOL_SIZE * sizeof(json_object_node));
+/* bytes that may follow a number or literal */
+static INLINE bool INLINE_ATTRIBUTE is_value_delimiter(char c) {
+  return whitespace_lookup[(unsigned char)c] || c == ',' || c == ']' || c == '}';
 }
 
-void json_free(json_value *v) {
-  json_array_node *array_node = v->u.array.items;
+const char *json_skip_value(const char *s, const char *end) {
+  json_value v;
+  uint8_t kind;
+  if (s == NULL || end == NULL || !skip_whitespace(&s, end))
+    return NULL;
+  kind = value_lookup[(unsigned char)*s];
+  switch (kind) {
+  case VALUE_OBJECT:
+  case VALUE_ARRAY:
+    return skip_containers(s + 1, end, 1);
+  case VALUE_STRING:
+    return skip_string_raw(s, end);
+  case VALUE_TRUE:
+  case VALUE_FALSE:
+  case VALUE_NULL:
+    if (!parse_literal(&s, end, &v, kind))
+      return NULL;
+    break;
+  case VALUE_NUMBER:
+    s++;
+    while (s < end && !is_value_delimiter(*s))
+      s++;
+    return s;
+  default:
+    return NULL;
+  }
+  return s < end && !is_value_delimiter(*s) ? NULL : s;
+}
+
+void json_cursor_init(json_cursor *c, const char *s, const char *end) {
+  memset(c, 0, sizeof(json_cursor));
+  c->ptr = s;
+  c->end = end;
+  c->failed = s == NULL || end == NULL || s >= end;
+}
+
+/* leaves the innermost container at s, which is past its closing bracket */
+static INLINE bool INLINE_ATTRIBUTE cursor_leave(json_cursor *c, const char *s) {
+  c->ptr = s;
+  c->first = false;
+  if (--c->depth == 0 && s != c->end)
+    c->failed = true;
+  return !c->failed;
+}
+
+bool json_cursor_next(json_cursor *c, reference *key, json_value *value) {
+  const char *s = c->ptr;
+  const char *end = c->end;
+  uint8_t kind;
+  uint8_t key_flags = 0;
+  if (key) {
+    key->ptr = NULL;
+    key->len = 0;
+  }
+  if (c->failed)
+    return false;
+  if (c->depth == 0) {
+    if (c->started)
+      return false;
+    c->started = true;
+    if (*s != '{' && *s != '[')
+      goto fail;
+  } else {
+    bool object = CURSOR_IS_OBJECT(c, c->depth - 1);
+    if (!skip_whitespace(&s, end))
+      goto fail;
+    if (*s == (object ? '}' : ']')) {
+      cursor_leave(c, s + 1);
+      return false;
+    }
+    if (!c->first) {
+      if (*s != ',')
+        goto fail;
+      s++;
+      if (!skip_whitespace(&s, end))
+        goto fail;
+    }
+    if (object) {
+      json_value k;
+      if (*s != '\"' || !parse_string(&s, end, &k))
+        goto fail;
+      if (!skip_whitespace(&s, end) || *s != ':')
+        goto fail;
+      s++;
+      if (key)
+        *key = k.u.string;
+      key_flags = k.flags;
+    }
+    c->first = false;
+  }
+  if (!skip_whitespace(&s, end))
+    goto fail;
+  kind = value_lookup[(unsigned char)*s];
+  switch (kind) {
+  case VALUE_OBJECT:
+  case VALUE_ARRAY:
+    if (c->depth >= JSON_CURSOR_DEPTH)
+      goto fail;
+    if (kind == VALUE_OBJECT) {
+      c->objects[c->depth >> 6] |= (uint64_t)1 << (c->depth & 63);
+      value->type = J_OBJECT;
+      value->u.object.items = NULL;
+      value->u.object.last = NULL;
+    } else {
+      c->objects[c->depth >> 6] &= ~((uint64_t)1 << (c->depth & 63));
+      value->type = J_ARRAY;
+      value->u.array.items = NULL;
+      value->u.array.last = NULL;
+    }
+    value->flags = 0;
+    c->depth++;
+    c->first = true;
+    s++;
+    break;
+  case VALUE_STRING:
+    value->type = J_STRING;
+    if (!parse_string(&s, end, value))
+      goto fail;
+    break;
+  case VALUE_TRUE:
+  case VALUE_FALSE:
+  case VALUE_NULL:
+    if (!parse_literal(&s, end, value, kind))
+      goto fail;
+    break;
+  case VALUE_NUMBER:
+    if (!parse_number(&s, end, value))
+      goto fail;
+    value->type = J_NUMBER;
+    break;
+  default:
+    goto fail;
+  }
+  value->key_flags = key_flags;
+  c->ptr = s;
+  return true;
+fail:
+  c->failed = true;
+  return false;
+}
+
+bool json_cursor_find_field(json_cursor *c, const char *key, size_t len, json_value *value) {
+  reference k;
+  if (c->failed || c->depth == 0 || !CURSOR_IS_OBJECT(c, c->depth - 1))
+    return false;
+  while (json_cursor_next(c, &k, value)) {
+    if (k.len == len && memcmp(k.ptr, key, len) == 0)
+      return true;
+    if ((value->type == J_OBJECT || value->type == J_ARRAY) && !json_cursor_skip(c))
+      return false;
+  }
+  return false;
+}
+
+bool json_cursor_skip(json_cursor *c) {
+  const char *s;
+  if (c->failed || c->depth == 0)
+    return false;
+  s = skip_containers(c->ptr, c->end, 1);
+  if (!s) {
+    c->failed = true;
+    return false;
+  }
+  return cursor_leave(c, s);
+}
+
+/* --- JSON Pointer --- */
+
+/* consumes the next n bytes of a pointer token, expanding ~0 and ~1, if they equal `bytes` */
+static bool pointer_token_consume(const char **token, const char *end, const char *bytes, size_t n) {
+  const char *t = *token;
+  while (n--) {
+    char c;
+    if (t == end)
+      return false;
+    c = *t++;
+    if (c == '~') {
+      if (t == end || (*t != '0' && *t != '1'))
+        return false;
+      c = *t++ == '0' ? '~' : '/';
+    }
+    if (c != *bytes++)
+      return false;
+  }
+  *token = t;
+  return true;
+}
+
+/* compares an object key with a pointer token; keys with escapes are decoded
+   one escape at a time, a surrogate pair counting as one */
+static bool pointer_token_equal(reference key, uint8_t key_flags, const char *token, size_t len) {
+  const char *p = key.ptr;
+  const char *end = key.ptr + key.len;
+  const char *token_end = token + len;
+  while (p < end) {
+    char unit[8];
+    size_t n = 1;
+    size_t decoded = 1;
+    if (*p == '\\' && (key_flags & JSON_STRING_HAS_ESCAPES)) {
+      n = 2;
+      if (p[1] == 'u' && end - p >= HEX_LOOKUP + 1) {
+        int32_t cp = hex4(p + 2);
+        n = HEX_LOOKUP + 1;
+        if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 2 * (HEX_LOOKUP + 1) && p[6] == '\\' && p[7] == 'u')
+          n = 2 * (HEX_LOOKUP + 1);
+      }
+      decoded = string_unescape(p, p + n, unit);
+      if (decoded == JSON_DECODE_ERROR)
+        return false;
+    } else {
+      unit[0] = *p;
+    }
+    if (!pointer_token_consume(&token, token_end, unit, decoded))
+      return false;
+    p += n;
+  }
+  return token == token_end;
+}
+
+static bool pointer_index(const char *token, size_t len, size_t *index) {
+  size_t i;
+  size_t n = 0;
+  if (len == 0 || (len > 1 && token[0] == '0'))
+    return false;
+  for (i = 0; i < len; i++) {
+    if (token[i] < '0' || token[i] > '9' || n > (SIZE_MAX - 9) / 10)
+      return false;
+    n = n * 10 + (size_t)(token[i] - '0');
+  }
+  *index = n;
+  return true;
+}
+
+bool json_parse_pointer(const char *s, const char *end, const char *pointer, json_value *out) {
+  json_cursor c;
+  json_value v;
+  reference key;
+  const char *stop;
+  bool whole;
+  if (pointer == NULL || out == NULL || (*pointer != '\0' && *pointer != '/'))
+    return false;
+  whole = *pointer == '\0';
+  json_cursor_init(&c, s, end);
+  if (!json_cursor_next(&c, NULL, &v))
+    return false;
+  while (*pointer == '/') {
+    const char *token = pointer + 1;
+    size_t len = strcspn(token, "/");
+    size_t index = 0;
+    bool found = false;
+    pointer = token + len;
+    if (v.type == J_ARRAY && !pointer_index(token, len, &index))
+      return false;
+    if (v.type != J_OBJECT && v.type != J_ARRAY)
+      return false;
+    while (json_cursor_next(&c, &key, &v)) {
+      if (key.ptr ? pointer_token_equal(key, v.key_flags, token, len) : index-- == 0) {
+        found = true;
+        break;
+      }
+      if ((v.type == J_OBJECT || v.type == J_ARRAY) && !json_cursor_skip(&c))
+        return false;
+    }
+    if (!found)
+      return false;
+  }
+  if (v.type != J_OBJECT && v.type != J_ARRAY) {
+    *out = v;
+    return true;
+  }
+  /* the cursor has just entered the target, build the tree of that value only;
+     the whole document must still end with its root */
+  return parse_iterative(c.ptr - 1, end, out, whole ? NULL : &stop);
+}
+
+/* --- projection --- */
+
+#define PROJECTION_KEY 0   /* object field */
+#define PROJECTION_ANY 1   /* [*], every array element */
+#define PROJECTION_INDEX 2 /* [n], one array element */
+#define PROJECTION_NONE 0  /* no child or sibling; node 0 is the root and never one */
+
+/* one segment of the path trie */
+typedef struct projection_node {
+  const char *name; /* key of a PROJECTION_KEY segment */
+  size_t len;
+  size_t index; /* element of a PROJECTION_INDEX segment */
+  size_t child;
+  size_t sibling;
+  uint8_t kind;
+  bool terminal; /* the whole value is kept */
+} projection_node;
+
+struct json_projection {
+  projection_node *nodes;
+  size_t count;
+  size_t capacity;
+  char *names; /* copy of the paths the segments point into */
+};
+
+/* finds or adds a child segment; PROJECTION_NONE when out of memory */
+static size_t projection_child(json_projection *projection, size_t parent, uint8_t kind, const char *name, size_t len, size_t index) {
+  projection_node *nodes;
+  size_t *link;
+  if (projection->count == projection->capacity) {
+    size_t capacity = projection->capacity * 2;
+    nodes = (projection_node *)realloc(projection->nodes, capacity * sizeof(projection_node));
+    if (!nodes)
+      return PROJECTION_NONE;
+    memset(nodes + projection->capacity, 0, (capacity - projection->capacity) * sizeof(projection_node));
+    projection->nodes = nodes;
+    projection->capacity = capacity;
+  }
+  nodes = projection->nodes;
+  link = &nodes[parent].child;
+  while (*link != PROJECTION_NONE) {
+    projection_node *node = &nodes[*link];
+    if (node->kind == kind && node->len == len && node->index == index && (len == 0 || memcmp(node->name, name, len) == 0))
+      return *link;
+    link = &node->sibling;
+  }
+  *link = projection->count;
+  nodes[projection->count].name = name;
+  nodes[projection->count].len = len;
+  nodes[projection->count].index = index;
+  nodes[projection->count].kind = kind;
+  return projection->count++;
+}
+
+static bool projection_add(json_projection *projection, const char *p) {
+  size_t parent = 0;
+  while (*p != '\0') {
+    if (*p == '[') {
+      size_t index = 0;
+      if (p[1] == '*' && p[2] == ']') {
+        parent = projection_child(projection, parent, PROJECTION_ANY, NULL, 0, 0);
+        if (parent == PROJECTION_NONE)
+          return false;
+        p += 3;
+      } else {
+        const char *digits = ++p;
+        while (*p >= '0' && *p <= '9')
+          p++;
+        if (*p != ']' || !pointer_index(digits, (size_t)(p - digits), &index))
+          return false;
+        parent = projection_child(projection, parent, PROJECTION_INDEX, NULL, 0, index);
+        if (parent == PROJECTION_NONE)
+          return false;
+        p++;
+      }
+      if (*p != '\0' && *p != '.' && *p != '[')
+        return false;
+    } else {
+      const char *name = p;
+      while (*p != '\0' && *p != '.' && *p != '[')
+        p++;
+      if (p == name)
+        return false;
+      parent = projection_child(projection, parent, PROJECTION_KEY, name, (size_t)(p - name), 0);
+      if (parent == PROJECTION_NONE)
+        return false;
+    }
+    if (*p == '.' && *++p == '\0')
+      return false;
+  }
+  projection->nodes[parent].terminal = true;
+  return true;
+}
+
+/* adds the segments below src to dst */
+static bool projection_merge(json_projection *projection, size_t dst, size_t src) {
+  size_t child;
+  if (projection->nodes[src].terminal)
+    projection->nodes[dst].terminal = true;
+  for (child = projection->nodes[src].child; child != PROJECTION_NONE; child = projection->nodes[child].sibling) {
+    projection_node node = projection->nodes[child];
+    size_t copy = projection_child(projection, dst, node.kind, node.name, node.len, node.index);
+    if (copy == PROJECTION_NONE || !projection_merge(projection, copy, child))
+      return false;
+  }
+  return true;
+}
+
+/* an element matched by [n] is also matched by a sibling [*]: give [n] the
+   segments of [*] as well, so an element follows exactly one trie node */
+static bool projection_fold(json_projection *projection, size_t parent) {
+  size_t any = PROJECTION_NONE;
+  size_t child;
+  for (child = projection->nodes[parent].child; child != PROJECTION_NONE; child = projection->nodes[child].sibling) {
+    if (projection->nodes[child].kind == PROJECTION_ANY)
+      any = child;
+  }
+  for (child = projection->nodes[parent].child; child != PROJECTION_NONE; child = projection->nodes[child].sibling) {
+    if (any != PROJECTION_NONE && projection->nodes[child].kind == PROJECTION_INDEX && !projection_merge(projection, child, any))
+      return false;
+    if (!projection_fold(projection, child))
+      return false;
+  }
+  return true;
+}
+
+json_projection *json_projection_compile(const char *const *paths, size_t count) {
+  json_projection *projection;
+  size_t size = 0;
+  size_t i;
+  char *name;
+  if (paths == NULL)
+    return NULL;
+  for (i = 0; i < count; i++) {
+    if (paths[i] == NULL)
+      return NULL;
+    size += strlen(paths[i]) + 1;
+  }
+  projection = (json_projection *)calloc(1, sizeof(json_projection));
+  if (!projection)
+    return NULL;
+  /* a path of n bytes has at most n segments; folding [*] into [n] may add more */
+  projection->capacity = size + 1;
+  projection->nodes = (projection_node *)calloc(projection->capacity, sizeof(projection_node));
+  projection->names = (char *)malloc(size + 1);
+  projection->count = 1;
+  if (!projection->nodes || !projection->names) {
+    json_projection_free(projection);
+    return NULL;
+  }
+  name = projection->names;
+  for (i = 0; i < count; i++) {
+    size_t len = strlen(paths[i]) + 1;
+    memcpy(name, paths[i], len);
+    if (!projection_add(projection, name)) {
+      json_projection_free(projection);
+      return NULL;
+    }
+    name += len;
+  }
+  if (!projection_fold(projection, 0)) {
+    json_projection_free(projection);
+    return NULL;
+  }
+  return projection;
+}
+
+void json_projection_free(json_projection *projection) {
+  if (!projection)
+    return;
+  free(projection->nodes);
+  free(projection->names);
+  free(projection);
+}
+
+/* keys are unique among siblings; an element prefers [n], which holds everything [*] selects */
+static size_t projection_match(const projection_node *nodes, size_t parent, const reference *key, size_t index) {
+  size_t any = PROJECTION_NONE;
+  size_t child;
+  for (child = nodes[parent].child; child != PROJECTION_NONE; child = nodes[child].sibling) {
+    const projection_node *node = &nodes[child];
+    if (key->ptr) {
+      if (node->kind == PROJECTION_KEY && node->len == key->len && memcmp(node->name, key->ptr, key->len) == 0)
+        return child;
+    } else if (node->kind == PROJECTION_INDEX && node->index == index) {
+      return child;
+    } else if (node->kind == PROJECTION_ANY) {
+      any = child;
+    }
+  }
+  return any;
+}
+
+/* appends an element to a container built outside the parsers; NULL when the pools are exhausted */
+static json_value *container_append(json_value *container, const reference *key) {
+  if (key->ptr) {
+    json_object_node *node;
+    if (context->next_object_index == JSON_VALUE_POOL_SIZE)
+      return NULL;
+    node = &context->object_nodes[context->next_object_index++];
+    node->next = NULL;
+    node->item.key = *key;
+    if (container->u.object.items == NULL)
+      container->u.object.items = node;
+    else
+      container->u.object.last->next = node;
+    container->u.object.last = node;
+    return &node->item.value;
+  } else {
+    json_array_node *node;
+    if (context->next_array_index == JSON_VALUE_POOL_SIZE)
+      return NULL;
+    node = &context->array_nodes[context->next_array_index++];
+    node->next = NULL;
+    if (container->u.array.items == NULL)
+      container->u.array.items = node;
+    else
+      container->u.array.last->next = node;
+    container->u.array.last = node;
+    return &node->item;
+  }
+}
+
+/* reads the elements of the container the cursor has just entered; recursion is bounded by the path length */
+static bool project_container(json_cursor *c, const projection_node *nodes, size_t parent, json_value *container) {
+  reference key;
+  json_value v;
+  size_t index = 0;
+  while (json_cursor_next(c, &key, &v)) {
+    bool nested = v.type == J_OBJECT || v.type == J_ARRAY;
+    size_t child = projection_match(nodes, parent, &key, index++);
+    json_value *slot;
+    if (child == PROJECTION_NONE || (!nodes[child].terminal && !nested)) {
+      if (nested && !json_cursor_skip(c))
+        return false;
+      continue;
+    }
+    slot = container_append(container, &key);
+    if (!slot)
+      return false;
+    *slot = v;
+    if (!nested)
+      continue;
+    if (nodes[child].terminal) {
+      const char *stop;
+      if (!parse_iterative(c->ptr - 1, c->end, slot, &stop) || !cursor_leave(c, stop))
+        return false;
+    } else if (!project_container(c, nodes, child, slot)) {
+      return false;
+    }
+  }
+  return !c->failed;
+}
+
+bool json_parse_projected(const char *s, const char *end, const json_projection *projection, json_value *root) {
+  json_cursor c;
+  if (projection == NULL || root == NULL)
+    return false;
+  if (projection->nodes[0].terminal)
+    return parse_iterative(s, end, root, NULL);
+  json_cursor_init(&c, s, end);
+  if (!json_cursor_next(&c, NULL, root))
+    return false;
+  return project_container(&c, projection->nodes, 0, root) && c.depth == 0;
+}
+
+/* --- incremental parser --- */
+
+struct json_stream_block {
+  json_stream_block *next;
+  size_t used;
+  size_t size;
+};
+
+static char *stream_alloc(json_stream *ctx, size_t len) {
+  json_stream_block *block = ctx->blocks;
+  if (!block || block->size - block->used < len) {
+    size_t size = len > JSON_STREAM_BLOCK_SIZE ? len : JSON_STREAM_BLOCK_SIZE;
+    block = (json_stream_block *)malloc(sizeof(json_stream_block) + size);
+    if (!block)
+      return NULL;
+    block->next = ctx->blocks;
+    block->used = 0;
+    block->size = size;
+    ctx->blocks = block;
+  }
+  block->used += len;
+  return (char *)(block + 1) + block->used - len;
+}
+
+static bool stream_copy(json_stream *ctx, const char **ptr, size_t len) {
+  char *copy;
+  /* in place, only tokens stitched together in the pending buffer are copied */
+  if (ctx->in_place && !(ctx->pending && *ptr >= ctx->pending && *ptr < ctx->pending + ctx->pending_len))
+    return true;
+  copy = stream_alloc(ctx, len);
+  if (!copy)
+    return false;
+  memcpy(copy, *ptr, len);
+  *ptr = copy;
+  return true;
+}
+
+static bool stream_push(json_stream *ctx, json_value *v) {
+  if ((size_t)(ctx->top + 1) >= ctx->capacity) {
+    size_t capacity = ctx->capacity ? ctx->capacity * 2 : JSON_STACK_INITIAL_SIZE;
+    json_value **stack;
+    if (capacity > JSON_STACK_SIZE)
+      capacity = JSON_STACK_SIZE;
+    if ((size_t)(ctx->top + 1) >= capacity)
+      return false;
+    stack = (json_value **)realloc(ctx->stack, capacity * sizeof(json_value *));
+    if (!stack)
+      return false;
+    ctx->stack = stack;
+    ctx->capacity = capacity;
+  }
+  ctx->stack[++ctx->top] = v;
+  return true;
+}
+
+static INLINE void INLINE_ATTRIBUTE stream_pop(json_stream *ctx) {
+  ctx->top--;
+  ctx->state = ctx->top == -1 ? STREAM_DONE : STREAM_NEXT;
+}
+
+static int stream_string(json_stream *ctx, const char **s, const char *end, json_value *v) {
+  const char *p = *s;
+  if (parse_string(&p, end, v)) {
+    if (!stream_copy(ctx, &v->u.string.ptr, v->u.string.len))
+      return TOKEN_INVALID;
+    *s = p;
+    return TOKEN_OK;
+  }
+  /* invalid only if the closing quote is already in the chunk */
+  for (p = *s + 1; p < end; p++) {
+    if (*p == '\"')
+      return TOKEN_INVALID;
+    if (*p == '\\')
+      p++;
+  }
+  return TOKEN_PARTIAL;
+}
+
+static int stream_number(json_stream *ctx, const char **s, const char *end, json_value *v) {
+  const char *p = *s;
+  /* a number is complete once a byte that cannot continue it is in the chunk */
+  if (parse_number(&p, end, v) && p < end) {
+    if (!stream_copy(ctx, &v->u.number.ptr, v->u.number.len))
+      return TOKEN_INVALID;
+    v->type = J_NUMBER;
+    *s = p;
+    return TOKEN_OK;
+  }
+  for (p = *s; p < end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E'); p++) {
+  }
+  return p == end ? TOKEN_PARTIAL : TOKEN_INVALID;
+}
+
+static int stream_literal(const char **s, const char *end, json_value *v, uint8_t kind) {
+  const char *text = kind == VALUE_TRUE ? "true" : kind == VALUE_FALSE ? "false" : "null";
+  size_t len = kind == VALUE_FALSE ? JSON_FALSE_LEN : JSON_TRUE_LEN;
+  size_t available = (size_t)(end - *s);
+  if (available < len)
+    return memcmp(*s, text, available) == 0 ? TOKEN_PARTIAL : TOKEN_INVALID;
+  if (!parse_literal(s, end, v, kind))
+    return TOKEN_INVALID;
+  /* literals reference static text instead of the chunk */
+  v->u.string.ptr = text;
+  return TOKEN_OK;
+}
+
+static json_stream_status stream_run(json_stream *ctx, const char *p, const char *end, const char **stop) {
+  json_value *container;
+  json_value key;
+  int token;
+  while (true) {
+    while (p < end && whitespace_lookup[(unsigned char)*p])
+      p++;
+    *stop = p;
+    if (p == end)
+      return ctx->state == STREAM_DONE ? JSON_STREAM_DONE : JSON_STREAM_MORE;
+    switch (ctx->state) {
+    case STREAM_VALUE: {
+      json_value *v = ctx->current;
+      uint8_t kind = value_lookup[(unsigned char)*p];
+      if (ctx->top == -1 && kind != VALUE_OBJECT && kind != VALUE_ARRAY)
+        return JSON_STREAM_ERROR;
+      switch (kind) {
+      case VALUE_OBJECT:
+      case VALUE_ARRAY:
+        v->type = kind == VALUE_OBJECT ? J_OBJECT : J_ARRAY;
+        v->u.array.items = NULL;
+        v->u.array.last = NULL;
+        if (!stream_push(ctx, v))
+          return JSON_STREAM_ERROR;
+        p++;
+        ctx->current = NULL;
+        ctx->state = kind == VALUE_OBJECT ? STREAM_OBJECT_FIRST : STREAM_ARRAY_FIRST;
+        continue;
+      case VALUE_STRING:
+        v->type = J_STRING;
+        token = stream_string(ctx, &p, end, v);
+        break;
+      case VALUE_TRUE:
+      case VALUE_FALSE:
+      case VALUE_NULL:
+        token = stream_literal(&p, end, v, kind);
+        break;
+      case VALUE_NUMBER:
+        token = stream_number(ctx, &p, end, v);
+        break;
+      default:
+        return JSON_STREAM_ERROR;
+      }
+      if (token != TOKEN_OK)
+        return token == TOKEN_PARTIAL ? JSON_STREAM_MORE : JSON_STREAM_ERROR;
+      ctx->current = NULL;
+      ctx->state = STREAM_NEXT;
+      continue;
+    }
+    case STREAM_ARRAY_FIRST:
+      if (*p == ']') {
+        p++;
+        stream_pop(ctx);
+        continue;
+      }
+      break;
+    case STREAM_OBJECT_FIRST:
+      if (*p == '}') {
+        p++;
+        stream_pop(ctx);
+        continue;
+      }
+      ctx->state = STREAM_OBJECT_KEY;
+      continue;
+    case STREAM_OBJECT_KEY:
+      if (*p != '\"')
+        return JSON_STREAM_ERROR;
+      token = stream_string(ctx, &p, end, &key);
+      if (token != TOKEN_OK)
+        return token == TOKEN_PARTIAL ? JSON_STREAM_MORE : JSON_STREAM_ERROR;
+      if (context->next_object_index == JSON_VALUE_POOL_SIZE)
+        return JSON_STREAM_ERROR;
+      container = ctx->stack[ctx->top];
+      {
+        json_object_node *node = &context->object_nodes[context->next_object_index++];
+        node->next = NULL;
+        node->item.key = key.u.string;
+        node->item.value.key_flags = key.flags;
+        if (container->u.object.items == NULL)
+          container->u.object.items = node;
+        else
+          container->u.object.last->next = node;
+        container->u.object.last = node;
+        ctx->current = &node->item.value;
+      }
+      ctx->state = STREAM_OBJECT_COLON;
+      continue;
+    case STREAM_OBJECT_COLON:
+      if (*p != ':')
+        return JSON_STREAM_ERROR;
+      p++;
+      ctx->state = STREAM_VALUE;
+      continue;
+    case STREAM_NEXT:
+      container = ctx->stack[ctx->top];
+      if (*p == (container->type == J_OBJECT ? '}' : ']')) {
+        p++;
+        stream_pop(ctx);
+        continue;
+      }
+      if (*p != ',')
+        return JSON_STREAM_ERROR;
+      p++;
+      if (container->type == J_OBJECT) {
+        ctx->state = STREAM_OBJECT_KEY;
+        continue;
+      }
+      break;
+    default:
+      return JSON_STREAM_ERROR;
+    }
+    /* a new array element: STREAM_ARRAY_FIRST with a value, or ',' in an array */
+    if (context->next_array_index == JSON_VALUE_POOL_SIZE)
+      return JSON_STREAM_ERROR;
+    container = ctx->stack[ctx->top];
+    {
+      json_array_node *node = &context->array_nodes[context->next_array_index++];
+      node->next = NULL;
+      if (container->u.array.items == NULL)
+        container->u.array.items = node;
+      else
+        container->u.array.last->next = node;
+      container->u.array.last = node;
+      ctx->current = &node->item;
+    }
+    ctx->state = STREAM_VALUE;
+  }
+}
+
+/* end of the carried string in [p, end), the bytes after the carried part:
+   past its closing quote, or NULL with ctx->escaped kept for the next chunk */
+static const char *stream_string_end(json_stream *ctx, const char *p, const char *end) {
+  if (ctx->escaped)
+    p++;
+  while (p < end) {
+    p = find_quote_or_backslash(p, end);
+    if (p >= end)
+      break;
+    if (*p == '"') {
+      ctx->escaped = false;
+      return p + 1;
+    }
+    p += 2;
+  }
+  ctx->escaped = p > end;
+  return NULL;
+}
+
+/* end of the carried token in [p, end), the bytes after the carried part, or
+   NULL if it goes on; a number needs the byte after it to be complete */
+static const char *stream_token_end(json_stream *ctx, const char *p, const char *end) {
+  size_t need;
+  switch (ctx->pending[0]) {
+  case '"':
+    return stream_string_end(ctx, p, end);
+  case 't':
+  case 'n':
+    need = JSON_TRUE_LEN;
+    break;
+  case 'f':
+    need = JSON_FALSE_LEN;
+    break;
+  default:
+    for (; p < end; p++) {
+      if (!((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E'))
+        return p + 1;
+    }
+    return NULL;
+  }
+  need = need > ctx->pending_len ? need - ctx->pending_len : 0;
+  return (size_t)(end - p) >= need ? p + need : NULL;
+}
+
+void json_stream_init(json_stream *ctx, json_value *root) {
+  memset(ctx, 0, sizeof(json_stream));
+  ctx->root = root;
+  ctx->current = root;
+  ctx->top = -1;
+  ctx->state = STREAM_VALUE;
+}
+
+static bool stream_carry(json_stream *ctx, const char *data, size_t len) {
+  if (ctx->pending_len + len > ctx->pending_cap) {
+    size_t capacity = (ctx->pending_len + len) * 2;
+    char *pending;
+    if (capacity < JSON_STREAM_PENDING_SIZE)
+      capacity = JSON_STREAM_PENDING_SIZE;
+    pending = (char *)realloc(ctx->pending, capacity);
+    if (!pending)
+      return false;
+    ctx->pending = pending;
+    ctx->pending_cap = capacity;
+  }
+  if (len > 0)
+    memcpy(ctx->pending + ctx->pending_len, data, len);
+  ctx->pending_len += len;
+  return true;
+}
+
+json_stream_status json_stream_feed(json_stream *ctx, const char *chunk, size_t len) {
+  const char *stop;
+  json_stream_status status;
+  if (!ctx || (!chunk && len > 0) || ctx->state == STREAM_FAILED)
+    return JSON_STREAM_ERROR;
+  if (ctx->pending_len > 0) {
+    /* a token is split: only the new bytes are scanned for its end, the
+       carried bytes are parsed once, when the end has arrived */
+    size_t carried = ctx->pending_len;
+    const char *token_end = stream_token_end(ctx, chunk, chunk + len);
+    size_t taken = token_end ? (size_t)(token_end - chunk) : len;
+    if (!stream_carry(ctx, chunk, taken)) {
+      ctx->state = STREAM_FAILED;
+      return JSON_STREAM_ERROR;
+    }
+    if (!token_end)
+      return JSON_STREAM_MORE;
+    status = stream_run(ctx, ctx->pending, ctx->pending + ctx->pending_len, &stop);
+    if (status == JSON_STREAM_ERROR) {
+      ctx->state = STREAM_FAILED;
+      return status;
+    }
+    /* the run may have stopped before the end of the stitched bytes, resume there */
+    taken = (size_t)(stop - ctx->pending) - carried;
+    ctx->pending_len = 0;
+    chunk += taken;
+    len -= taken;
+  }
+  status = stream_run(ctx, chunk, chunk + len, &stop);
+  if (status == JSON_STREAM_ERROR) {
+    ctx->state = STREAM_FAILED;
+    return status;
+  }
+  if (!stream_carry(ctx, stop, (size_t)(chunk + len - stop))) {
+    ctx->state = STREAM_FAILED;
+    return JSON_STREAM_ERROR;
+  }
+  /* a carried string was scanned to the end of the chunk already; keep where its escapes stand */
+  ctx->escaped = false;
+  if (ctx->pending_len > 0 && ctx->pending[0] == '"')
+    stream_string_end(ctx, ctx->pending + 1, ctx->pending + ctx->pending_len);
+  return status;
+}
+
+void json_stream_free(json_stream *ctx) {
+  json_stream_block *block;
+  if (!ctx)
+    return;
+  block = ctx->blocks;
+  while (block) {
+    json_stream_block *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(ctx->stack);
+  free(ctx->pending);
+  memset(ctx, 0, sizeof(json_stream));
+  ctx->top = -1;
+  ctx->state = STREAM_FAILED;
+}
+
+bool json_parse_iov(const json_iovec *iov, int count, json_value *root, json_stream *ctx) {
+  json_stream_status status = JSON_STREAM_MORE;
+  int i;
+  if (ctx == NULL)
+    return false;
+  json_stream_init(ctx, root);
+  if (iov == NULL || count < 0 || root == NULL)
+    return false;
+  ctx->in_place = true;
+  for (i = 0; i < count && status != JSON_STREAM_ERROR; i++)
+    status = json_stream_feed(ctx, (const char *)iov[i].base, iov[i].len);
+  return status == JSON_STREAM_DONE && ctx->pending_len == 0;
+}
+
+/* --- multi-document input --- */
+
+static INLINE const char *INLINE_ATTRIBUTE find_newline(const char *p, const char *end) {
+#ifdef __SSE2__
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (p + (SSE2_CHUNK_SIZE - 1) < end) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), newline));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += SSE2_CHUNK_SIZE;
+  }
+#endif
+  while (p < end && *p != '\n')
+    p++;
+  return p;
+}
+
+bool json_parse_lines(const char *s, const char *end, json_document_callback cb, void *user, size_t *count) {
+  size_t documents = 0;
+  bool result = true;
+  if (count)
+    *count = 0;
+  if (!s || !end || !cb)
+    return false;
+  while (s < end) {
+    const char *line_end = find_newline(s, end);
+    const char *next = line_end < end ? line_end + 1 : end;
+    while (s < line_end && whitespace_lookup[(unsigned char)*s])
+      s++;
+    while (line_end > s && whitespace_lookup[(unsigned char)line_end[-1]])
+      line_end--;
+    if (s < line_end) {
+      json_value doc;
+      reference source;
+      memset(&doc, 0, sizeof(json_value));
+      if (!parse_iterative(s, line_end, &doc, NULL)) {
+        json_reset();
+        result = false;
+        break;
+      }
+      source.ptr = s;
+      source.len = (size_t)(line_end - s);
+      result = cb(&doc, source, user);
+      json_reset();
+      documents++;
+      if (!result)
+        break;
+    }
+    s = next;
+  }
+  if (count)
+    *count = documents;
+  return result;
+}
+
+bool json_parse_documents(const char *s, const char *end, json_document_callback cb, void *user, size_t *count) {
+  size_t documents = 0;
+  bool result = true;
+  if (count)
+    *count = 0;
+  if (!s || !end || !cb)
+    return false;
+  while (true) {
+    json_value doc;
+    reference source;
+    const char *stop;
+    bool proceed;
+    /* whitespace and RFC 7464 record separators between documents */
+    while (s < end && (whitespace_lookup[(unsigned char)*s] || *s == JSON_RECORD_SEPARATOR))
+      s++;
+    if (s == end)
+      break;
+    memset(&doc, 0, sizeof(json_value));
+    if (!parse_iterative(s, end, &doc, &stop)) {
+      json_reset();
+      result = false;
+      break;
+    }
+    source.ptr = s;
+    source.len = (size_t)(stop - s);
+    proceed = cb(&doc, source, user);
+    json_reset();
+    documents++;
+    if (!proceed) {
+      result = false;
+      break;
+    }
+    s = stop;
+  }
+  if (count)
+    *count = documents;
+  return result;
+}
+
+/* node pools of a worker thread, released with context_destroy() */
+static json_context *context_create(void) {
+  json_context *ctx = (json_context *)calloc(1, sizeof(json_context));
+  if (!ctx)
+    return NULL;
+  ctx->array_nodes = (json_array_node *)calloc(JSON_VALUE_POOL_SIZE, sizeof(json_array_node));
+  ctx->object_nodes = (json_object_node *)calloc(JSON_VALUE_POOL_SIZE, sizeof(json_object_node));
+  ctx->stack = ctx->stack_storage;
+  ctx->stack_capacity = JSON_STACK_INITIAL_SIZE;
+  if (!ctx->array_nodes || !ctx->object_nodes) {
+    free(ctx->array_nodes);
+    free(ctx->object_nodes);
+    free(ctx);
+    return NULL;
+  }
+  return ctx;
+}
+
+static void context_destroy(json_context *ctx) {
+  if (!ctx)
+    return;
+  if (ctx->stack != ctx->stack_storage)
+    free(ctx->stack);
+  free(ctx->array_nodes);
+  free(ctx->object_nodes);
+  free(ctx);
+}
+
+typedef void (*worker_function)(void *worker);
+
+typedef struct {
+  worker_function run;
+  void *worker;
+} worker_thread;
+
+#ifdef _WIN32
+static DWORD WINAPI worker_thread_main(LPVOID arg) {
+  worker_thread *thread = (worker_thread *)arg;
+  thread->run(thread->worker);
+  return 0;
+}
+#else
+static void *worker_thread_main(void *arg) {
+  worker_thread *thread = (worker_thread *)arg;
+  thread->run(thread->worker);
+  return NULL;
+}
+#endif
+
+/* runs `run` for each of `count` workers of `size` bytes; worker 0, and any worker whose thread cannot start, runs on the caller */
+static void run_workers(worker_function run, void *workers, size_t size, size_t count) {
+  worker_thread *threads = (worker_thread *)calloc(count, sizeof(worker_thread));
+#ifdef _WIN32
+  HANDLE *handles = (HANDLE *)calloc(count, sizeof(HANDLE));
+#else
+  pthread_t *handles = (pthread_t *)calloc(count, sizeof(pthread_t));
+  bool *started = (bool *)calloc(count, sizeof(bool));
+#endif
+  size_t i;
+  for (i = 1; threads && handles && i < count; i++) {
+    threads[i].run = run;
+    threads[i].worker = (char *)workers + i * size;
+#ifdef _WIN32
+    handles[i] = CreateThread(NULL, 0, worker_thread_main, &threads[i], 0, NULL);
+#else
+    if (started)
+      started[i] = pthread_create(&handles[i], NULL, worker_thread_main, &threads[i]) == 0;
+#endif
+  }
+  run(workers);
+  for (i = 1; i < count; i++) {
+#ifdef _WIN32
+    if (threads && handles && handles[i]) {
+      WaitForSingleObject(handles[i], INFINITE);
+      CloseHandle(handles[i]);
+      continue;
+    }
+#else
+    if (threads && handles && started && started[i]) {
+      pthread_join(handles[i], NULL);
+      continue;
+    }
+#endif
+    run((char *)workers + i * size);
+  }
+  free(threads);
+  free(handles);
+#ifndef _WIN32
+  free(started);
+#endif
+}
+
+typedef struct {
+  const char *s;
+  const char *end;
+  size_t worker;
+  json_worker_callback cb;
+  void *user;
+  size_t count;
+  bool result;
+} lines_worker;
+
+static bool lines_worker_document(json_value *doc, reference source, void *user) {
+  lines_worker *w = (lines_worker *)user;
+  return w->cb(doc, source, w->worker, w->user);
+}
+
+static void lines_worker_run(void *worker) {
+  lines_worker *w = (lines_worker *)worker;
+  json_context *previous = context;
+  json_context *ctx = context_create();
+  w->count = 0;
+  w->result = false;
+  if (!ctx)
+    return;
+  context = ctx;
+  w->result = json_parse_lines(w->s, w->end, lines_worker_document, w, &w->count);
+  context = previous;
+  context_destroy(ctx);
+}
+
+bool json_parse_lines_parallel(const char *s, const char *end, size_t threads, json_worker_callback cb, void *user, size_t *count) {
+  lines_worker *workers;
+  size_t len;
+  size_t i;
+  bool result = true;
+  size_t documents = 0;
+  if (count)
+    *count = 0;
+  if (!s || !end || !cb || end < s)
+    return false;
+  if (threads == 0)
+    threads = 1;
+  workers = (lines_worker *)calloc(threads, sizeof(lines_worker));
+  if (!workers)
+    return false;
+  /* cut every len / threads bytes, then move each cut past the next newline */
+  len = (size_t)(end - s) / threads;
+  for (i = 0; i < threads; i++) {
+    const char *from = i == 0 ? s : workers[i - 1].end;
+    const char *to = end;
+    if (i + 1 < threads) {
+      to = s + len * (i + 1);
+      if (to < from)
+        to = from;
+      to = find_newline(to, end);
+      if (to < end)
+        to++;
+    }
+    workers[i].s = from;
+    workers[i].end = to;
+    workers[i].worker = i;
+    workers[i].cb = cb;
+    workers[i].user = user;
+  }
+  run_workers(lines_worker_run, workers, sizeof(lines_worker), threads);
+  for (i = 0; i < threads; i++) {
+    documents += workers[i].count;
+    result = result && workers[i].result;
+  }
+  free(workers);
+  if (count)
+    *count = documents;
+  return result;
+}
+
+bool json_parse_array_elements(const char *s, const char *end, json_document_callback cb, void *user, size_t *count) {
+  json_cursor c;
+  json_value element;
+  size_t elements = 0;
+  if (count)
+    *count = 0;
+  if (cb == NULL || s == NULL || end == NULL || s >= end || *s != '[')
+    return false;
+  json_cursor_init(&c, s, end);
+  if (!json_cursor_next(&c, NULL, &element))
+    return false;
+  while (json_cursor_next(&c, NULL, &element)) {
+    reference source;
+    bool proceed;
+    if (element.type == J_OBJECT || element.type == J_ARRAY) {
+      const char *stop;
+      source.ptr = c.ptr - 1;
+      if (!parse_iterative(source.ptr, end, &element, &stop) || !cursor_leave(&c, stop)) {
+        json_reset();
+        break;
+      }
+      source.len = (size_t)(stop - source.ptr);
+    } else if (element.type == J_STRING) {
+      source.ptr = element.u.string.ptr - 1;
+      source.len = element.u.string.len + 2;
+    } else {
+      source = element.u.string;
+    }
+    proceed = cb(&element, source, user);
+    json_reset();
+    elements++;
+    if (!proceed)
+      break;
+  }
+  if (count)
+    *count = elements;
+  /* a stopped callback or a bad element leaves the outer array open */
+  return !c.failed && c.depth == 0;
+}
+
+/* --- parallel parsing --- */
+
+struct json_arena {
+  json_context **contexts;
+  size_t count;
+};
+
+typedef struct {
+  const char *s;         /* position right before the first element, comma included */
+  const char *end;
+  bool first;            /* s is directly after the opening bracket */
+  bool object;           /* the root is an object */
+  size_t elements;       /* number of root elements to parse */
+  json_context *context; /* pools the elements are parsed into */
+  json_value list;       /* parsed elements, linked like the members of the root */
+  bool result;
+} document_worker;
+
+static void document_worker_run(void *worker) {
+  document_worker *w = (document_worker *)worker;
+  json_context *previous = context;
+  json_cursor c;
+  reference key;
+  json_value v;
+  size_t i;
+  context = w->context;
+  /* resume inside the root at an element boundary found by the structural pass */
+  json_cursor_init(&c, w->s, w->end);
+  c.started = true;
+  c.depth = 1;
+  c.first = w->first;
+  c.objects[0] = w->object ? 1 : 0;
+  for (i = 0; i < w->elements; i++) {
+    json_value *slot;
+    if (!json_cursor_next(&c, &key, &v))
+      break;
+    slot = container_append(&w->list, &key);
+    if (!slot)
+      break;
+    *slot = v;
+    if (v.type == J_OBJECT || v.type == J_ARRAY) {
+      const char *stop;
+      if (!parse_iterative(c.ptr - 1, c.end, slot, &stop) || !cursor_leave(&c, stop))
+        break;
+    }
+  }
+  w->result = i == w->elements;
+  context = previous;
+}
+
+void json_arena_free(json_arena *arena) {
+  size_t i;
+  if (!arena)
+    return;
+  for (i = 0; i < arena->count; i++)
+    context_destroy(arena->contexts[i]);
+  free(arena->contexts);
+  free(arena);
+}
+
+bool json_parse_parallel(const char *s, const char *end, size_t threads, json_value *root, json_arena **arena) {
+  json_cursor c;
+  json_value v;
+  document_worker *workers;
+  json_arena *nodes;
+  size_t used = 0;
+  size_t step;
+  size_t i;
+  bool result = true;
+  if (arena)
+    *arena = NULL;
+  if (root == NULL || arena == NULL)
+    return false;
+  if (threads == 0)
+    threads = 1;
+  json_cursor_init(&c, s, end);
+  if (!json_cursor_next(&c, NULL, root))
+    return false;
+  workers = (document_worker *)calloc(threads, sizeof(document_worker));
+  if (!workers)
+    return false;
+  /* structural pass: walk the root elements with the bracket-counting scan,
+     a new worker takes over at the first element past each len / threads cut */
+  step = (size_t)(end - s) / threads;
+  while (true) {
+    const char *position = c.ptr;
+    bool first = c.first;
+    if (!json_cursor_next(&c, NULL, &v))
+      break;
+    if (used == 0 || (used < threads && (size_t)(position - s) >= step * used)) {
+      workers[used].s = position;
+      workers[used].end = end;
+      workers[used].first = first;
+      workers[used].object = root->type == J_OBJECT;
+      workers[used].list.type = root->type;
+      used++;
+    }
+    workers[used - 1].elements++;
+    if ((v.type == J_OBJECT || v.type == J_ARRAY) && !json_cursor_skip(&c))
+      break;
+  }
+  nodes = (json_arena *)calloc(1, sizeof(json_arena));
+  if (c.failed || c.depth != 0 || !nodes) {
+    free(nodes);
+    free(workers);
+    return false;
+  }
+  nodes->contexts = (json_context **)calloc(used ? used : 1, sizeof(json_context *));
+  result = nodes->contexts != NULL;
+  for (i = 0; result && i < used; i++) {
+    nodes->contexts[i] = workers[i].context = context_create();
+    nodes->count++;
+    result = workers[i].context != NULL;
+  }
+  if (result && used > 0)
+    run_workers(document_worker_run, workers, sizeof(document_worker), used);
+  /* stitch the per-worker member lists together, O(workers) */
+  for (i = 0; result && i < used; i++) {
+    json_value *list = &workers[i].list;
+    result = workers[i].result;
+    if (root->type == J_OBJECT && list->u.object.items) {
+      if (root->u.object.items == NULL)
+        root->u.object.items = list->u.object.items;
+      else
+        root->u.object.last->next = list->u.object.items;
+      root->u.object.last = list->u.object.last;
+    } else if (root->type == J_ARRAY && list->u.array.items) {
+      if (root->u.array.items == NULL)
+        root->u.array.items = list->u.array.items;
+      else
+        root->u.array.last->next = list->u.array.items;
+      root->u.array.last = list->u.array.last;
+    }
+  }
+  free(workers);
+  if (!result) {
+    json_arena_free(nodes);
+    if (root->type == J_OBJECT) {
+      root->u.object.items = NULL;
+      root->u.object.last = NULL;
+    } else {
+      root->u.array.items = NULL;
+      root->u.array.last = NULL;
+    }
+    return false;
+  }
+  *arena = nodes;
+  return true;
+}
+
+/* --- file input --- */
+
+/* files usually end with a newline, which the parser does not accept after the root */
+static const char *trim_trailing_whitespace(const char *s, const char *end) {
+  while (end > s && whitespace_lookup[(unsigned char)end[-1]])
+    end--;
+  return end;
+}
+
+struct json_file {
+  const char *data;
+  size_t size;
+#ifdef _WIN32
+  HANDLE handle;
+  HANDLE mapping;
+#endif
+};
+
+static json_file *file_map(const char *path) {
+  json_file *file = (json_file *)calloc(1, sizeof(json_file));
+#ifdef _WIN32
+  LARGE_INTEGER size;
+  if (!file)
+    return NULL;
+  file->handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file->handle != INVALID_HANDLE_VALUE && GetFileSizeEx(file->handle, &size) && size.QuadPart > 0 && (ULONGLONG)size.QuadPart <= (ULONGLONG)SIZE_MAX) {
+    file->size = (size_t)size.QuadPart;
+    file->mapping = CreateFileMappingA(file->handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (file->mapping)
+      file->data = (const char *)MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+  }
+#else
+  struct stat st;
+  int fd;
+  if (!file)
+    return NULL;
+  fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        file->data = (const char *)data;
+        file->size = (size_t)st.st_size;
+#ifdef MADV_SEQUENTIAL
+        madvise(data, file->size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+        madvise(data, file->size, MADV_HUGEPAGE);
+#endif
+      }
+    }
+    close(fd);
+  }
+#endif
+  if (!file->data) {
+    json_file_close(file);
+    return NULL;
+  }
+  return file;
+}
+
+void json_file_close(json_file *file) {
+  if (!file)
+    return;
+#ifdef _WIN32
+  if (file->data)
+    UnmapViewOfFile(file->data);
+  if (file->mapping)
+    CloseHandle(file->mapping);
+  if (file->handle && file->handle != INVALID_HANDLE_VALUE)
+    CloseHandle(file->handle);
+#else
+  if (file->data)
+    munmap((void *)file->data, file->size);
+#endif
+  free(file);
+}
+
+bool json_parse_file(const char *path, json_value *root, json_file **file) {
+  json_file *mapped;
+  const char *end;
+  if (file)
+    *file = NULL;
+  if (path == NULL || root == NULL || file == NULL)
+    return false;
+  mapped = file_map(path);
+  if (!mapped)
+    return false;
+  end = trim_trailing_whitespace(mapped->data, mapped->data + mapped->size);
+  if (!parse_iterative(mapped->data, end, root, NULL)) {
+    json_file_close(mapped);
+    return false;
+  }
+  *file = mapped;
+  return true;
+}
+
+/* reads a whole file into *buffer, growing it to hold JSON_PADDING more bytes */
+static bool file_read(const char *path, char **buffer, size_t *capacity, size_t *size) {
+  size_t length = 0;
+  size_t done = 0;
+  bool result = false;
+#ifdef _WIN32
+  LARGE_INTEGER file_size;
+  HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (handle == INVALID_HANDLE_VALUE)
+    return false;
+  if (GetFileSizeEx(handle, &file_size) && (ULONGLONG)file_size.QuadPart < (ULONGLONG)(SIZE_MAX - JSON_PADDING))
+    length = (size_t)file_size.QuadPart;
+  else
+    length = SIZE_MAX;
+#else
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  if (fstat(fd, &st) == 0 && (unsigned long long)st.st_size < (unsigned long long)(SIZE_MAX - JSON_PADDING))
+    length = (size_t)st.st_size;
+  else
+    length = SIZE_MAX;
+#endif
+  if (length != SIZE_MAX && length + JSON_PADDING > *capacity) {
+    char *grown = (char *)realloc(*buffer, length + JSON_PADDING);
+    if (grown) {
+      *buffer = grown;
+      *capacity = length + JSON_PADDING;
+    }
+  }
+  if (length != SIZE_MAX && length + JSON_PADDING <= *capacity) {
+    while (done < length) {
+#ifdef _WIN32
+      DWORD chunk = length - done > 0x40000000 ? 0x40000000 : (DWORD)(length - done);
+      DWORD n = 0;
+      if (!ReadFile(handle, *buffer + done, chunk, &n, NULL) || n == 0)
+        break;
+#else
+      ssize_t n = pread(fd, *buffer + done, length - done, (off_t)done);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        break;
+#endif
+      done += (size_t)n;
+    }
+    result = done == length;
+  }
+#ifdef _WIN32
+  CloseHandle(handle);
+#else
+  close(fd);
+#endif
+  *size = done;
+  return result;
+}
+
+/* asks the kernel to start reading a file into the page cache in the background,
+   so that the file_read() of it later finds the data there */
+static void file_prefetch(const char *path) {
+#ifdef _WIN32
+  (void)path;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return;
+#ifdef __APPLE__
+  {
+    struct stat st;
+    struct radvisory advice;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      advice.ra_offset = 0;
+      advice.ra_count = st.st_size > 0x7FFFFFFF ? 0x7FFFFFFF : (int)st.st_size;
+      fcntl(fd, F_RDADVISE, &advice);
+    }
+  }
+#else
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+  close(fd);
+#endif
+}
+
+typedef struct {
+  const char *const *paths;
+  size_t count;
+  size_t worker; /* index of the worker and of its first file */
+  size_t step;   /* number of workers */
+  json_file_callback cb;
+  void *user;
+  bool result;
+} files_worker;
+
+static void files_worker_run(void *worker) {
+  files_worker *w = (files_worker *)worker;
+  json_context *previous = context;
+  json_context *ctx = context_create();
+  char *buffer = NULL;
+  size_t capacity = 0;
+  size_t i;
+  w->result = ctx != NULL;
+  if (!ctx)
+    return;
+  context = ctx;
+  for (i = w->worker; i < w->count; i += w->step) {
+    json_value doc;
+    reference source;
+    size_t size;
+    bool parsed = false;
+    bool proceed;
+    memset(&doc, 0, sizeof(json_value));
+    source.ptr = NULL;
+    source.len = 0;
+    if (w->paths[i] && file_read(w->paths[i], &buffer, &capacity, &size)) {
+      /* the worker's next file is read ahead while this one is parsed */
+      if (i + w->step < w->count && w->paths[i + w->step])
+        file_prefetch(w->paths[i + w->step]);
+      /* the buffer is ours: zero the trailing whitespace and the padding for the padded kernels */
+      const char *end = trim_trailing_whitespace(buffer, buffer + size);
+      memset(buffer + (end - buffer), 0, (size_t)(buffer + size - end) + JSON_PADDING);
+      parsed = parse_iterative_padded(buffer, end, &doc, NULL);
+      source.ptr = buffer;
+      source.len = (size_t)(end - buffer);
+    }
+    if (!parsed)
+      w->result = false;
+    proceed = w->cb(parsed ? &doc : NULL, source, i, w->worker, w->user);
+    json_reset();
+    if (!proceed) {
+      w->result = false;
+      break;
+    }
+  }
+  context = previous;
+  context_destroy(ctx);
+  free(buffer);
+}
+
+bool json_parse_files(const char *const *paths, size_t count, size_t threads, json_file_callback cb, void *user) {
+  files_worker *workers;
+  size_t i;
+  bool result = true;
+  if (paths == NULL || cb == NULL)
+    return false;
+  if (threads == 0)
+    threads = 1;
+  if (threads > count)
+    threads = count ? count : 1;
+  workers = (files_worker *)calloc(threads, sizeof(files_worker));
+  if (!workers)
+    return false;
+  for (i = 0; i < threads; i++) {
+    workers[i].paths = paths;
+    workers[i].count = count;
+    workers[i].worker = i;
+    workers[i].step = threads;
+    workers[i].cb = cb;
+    workers[i].user = user;
+  }
+  run_workers(files_worker_run, workers, sizeof(files_worker), threads);
+  for (i = 0; i < threads; i++)
+    result = result && workers[i].result;
+  free(workers);
+  return result;
+}
+
+INLINE bool INLINE_ATTRIBUTE json_parse(const char *s, const char *end, json_value *root) {
+  size_t len = end - s;
+  if (s == NULL || len == 0 || *s == '\0')
+    return false;
+  if (*s != '{' && *s != '[') {
+    return false;
+  }
+  return parse_json(&s, end, root) && s == end;
+}
+
+bool json_equal(const json_value *a, const json_value *b) {
+  if (a == b)
+    return true;
+  if (!a || !b)
+    return false;
+  if (a->type != b->type)
+    return false;
+  switch (a->type) {
+  case J_NULL:
+    return true;
+  case J_BOOLEAN:
+    return a->u.boolean.len == b->u.boolean.len && strncmp(a->u.boolean.ptr, b->u.boolean.ptr, a->u.boolean.len) == 0;
+  case J_NUMBER: {
+    return a->u.number.len == b->u.number.len && strncmp(a->u.number.ptr, b->u.number.ptr, a->u.number.len) == 0;
+  }
+  case J_STRING:
+    if (a->u.string.ptr == NULL && b->u.string.ptr == NULL)
+      return true;
+    return a->u.string.ptr && b->u.string.ptr && a->u.string.len == b->u.string.len && strncmp(a->u.string.ptr, b->u.string.ptr, a->u.string.len) == 0;
+  case J_ARRAY:
+    return json_array_equal(a, b);
+  case J_OBJECT:
+    return json_object_equal(a, b);
+  default:
+    return false;
+  }
+}
+
+INLINE void INLINE_ATTRIBUTE json_reset(void) {
+  context->next_array_index = 0;
+  context->next_object_index = 0;
+}
+
+INLINE void INLINE_ATTRIBUTE json_cleanup(void) {
+  if (context->stack != context->stack_storage)
+    free(context->stack);
+  context->stack = context->stack_storage;
+  context->stack_capacity = JSON_STACK_INITIAL_SIZE;
+  memset(context->array_nodes, 0, JSON_VALUE_POOL_SIZE * sizeof(json_array_node));
+  memset(context->object_nodes, 0, JSON_VALUE_POOL_SIZE * sizeof(json_object_node));
+}
+
+void json_free(json_value *v) {
+  json_array_node *array_node = v->u.array.items;
   json_object_node *object_node = v->u.object.items;
   switch (v->type) {
   case J_STRING:
@@ -1325,6 +3732,111 @@ INLINE void INLINE_ATTRIBUTE json_print(const json_value *v, FILE *out) {
   print_value(v, 0, out);
 }
 
+bool json_get_double(const json_value *v, double *out) {
+  if (!v || v->type != J_NUMBER || !out)
+    return false;
+#ifdef NUMBER_DECODING
+  if (v->flags & JSON_NUMBER_DECODED) {
+    *out = (v->flags & JSON_NUMBER_INTEGER) ? (double)v->u.number.value.integer : v->u.number.value.real;
+    return true;
+  }
+#endif
+  return number_to_double(v->u.number.ptr, v->u.number.len, out);
+}
+
+bool json_get_int64(const json_value *v, int64_t *out) {
+  bool negative;
+  uint64_t magnitude;
+  if (!v || v->type != J_NUMBER || !out)
+    return false;
+#ifdef NUMBER_DECODING
+  if (v->flags & JSON_NUMBER_DECODED) {
+    if (!(v->flags & JSON_NUMBER_INTEGER))
+      return false;
+    *out = v->u.number.value.integer;
+    return true;
+  }
+#endif
+  if (!number_to_integer(v->u.number.ptr, v->u.number.len, &negative, &magnitude))
+    return false;
+  if (negative) {
+    if (magnitude > (uint64_t)INT64_MAX + 1)
+      return false;
+    *out = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)magnitude;
+    return true;
+  }
+  if (magnitude > (uint64_t)INT64_MAX)
+    return false;
+  *out = (int64_t)magnitude;
+  return true;
+}
+
+bool json_get_uint64(const json_value *v, uint64_t *out) {
+  bool negative;
+  uint64_t magnitude;
+  if (!v || v->type != J_NUMBER || !out)
+    return false;
+#ifdef NUMBER_DECODING
+  /* values above INT64_MAX are left undecoded and re-read from the text */
+  if ((v->flags & (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER)) == (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER)) {
+    if (v->u.number.value.integer < 0)
+      return false;
+    *out = (uint64_t)v->u.number.value.integer;
+    return true;
+  }
+#endif
+  if (!number_to_integer(v->u.number.ptr, v->u.number.len, &negative, &magnitude))
+    return false;
+  if (negative && magnitude != 0)
+    return false;
+  *out = magnitude;
+  return true;
+}
+
+size_t json_get_doubles(const json_value *array, double *out, size_t count) {
+  size_t i = 0;
+  if (!array || array->type != J_ARRAY || !out)
+    return 0;
+  json_array_node *array_items = array->u.array.items;
+  while (array_items && i < count && json_get_double(&array_items->item, &out[i])) {
+    array_items = array_items->next;
+    i++;
+  }
+  return i;
+}
+
+size_t json_get_int64s(const json_value *array, int64_t *out, size_t count) {
+  size_t i = 0;
+  if (!array || array->type != J_ARRAY || !out)
+    return 0;
+  json_array_node *array_items = array->u.array.items;
+  while (array_items && i < count && json_get_int64(&array_items->item, &out[i])) {
+    array_items = array_items->next;
+    i++;
+  }
+  return i;
+}
+
+size_t json_string_decode(const json_value *v, char *dst) {
+  if (!v || v->type != J_STRING || !dst)
+    return JSON_DECODE_ERROR;
+  if (!(v->flags & JSON_STRING_HAS_ESCAPES)) {
+    memcpy(dst, v->u.string.ptr, v->u.string.len);
+    return v->u.string.len;
+  }
+  return string_unescape(v->u.string.ptr, v->u.string.ptr + v->u.string.len, dst);
+}
+
+size_t json_key_decode(const json_object *item, char *dst) {
+  if (!item || !dst)
+    return JSON_DECODE_ERROR;
+  if (!(item->value.key_flags & JSON_STRING_HAS_ESCAPES)) {
+    memcpy(dst, item->key.ptr, item->key.len);
+    return item->key.len;
+  }
+  return string_unescape(item->key.ptr, item->key.ptr + item->key.len, dst);
+}
+
 INLINE const char *INLINE_ATTRIBUTE json_error_string(json_error error) {
   switch (error) {
   case E_OK:
@@ -43,8 +43,11 @@
 #define DICTIONARY_SIZE 16          /* Size of lookup dictionary for parsing optimization */
 #define MAX_BUFFER_SIZE 0x100       /* Maximum buffer size for temporary string operations (256 bytes) */
 #define JSON_VALUE_POOL_SIZE 0xFFFF /* Maximum number of json_value objects that can be allocated (65535) */
-#define JSON_STACK_SIZE 0xFFFF      /* Maximum stack depth for recursive parsing (65535 levels) */
+#ifndef JSON_STACK_SIZE
+#define JSON_STACK_SIZE 0xFFFF      /* Maximum nesting depth of the iterative parser and validator (65535 levels) */
+#endif
 #define LOOKUP_TABLE_SIZE 256       /* Size of character lookup tables for whitespace/parsing (256 for all byte values) */
+#define JSON_PADDING 64             /* Zero bytes json_parse_padded() expects after the input */
 
 #include "headers.h"
 
@@ -95,6 +98,20 @@ typedef enum : uint8_t {
   E_NO_MEMORY_ARRAY = E_ARRAY | 0x40,              /* Out of memory while parsing parsing array */
 } json_error;
 
+/**
+ * @brief Error code and location of a failed parse or validation.
+ *
+ * Filled in by json_parse_located() and json_validate_located(). The line and
+ * column are derived from the offset only after a failure; on success all
+ * fields are zero.
+ */
+typedef struct json_result {
+  json_error error; /* E_OK, or the reason the input was rejected */
+  size_t offset;    /* Byte offset of the offending byte or token from the start of the input */
+  size_t line;      /* 1-based line of the offset */
+  size_t column;    /* 1-based byte column of the offset within its line */
+} json_result;
+
 /**
  * @brief Enumeration of JSON value types.
  *
@@ -122,6 +139,41 @@ typedef struct reference {
   size_t len;      /* Length of the referenced substring in bytes */
 } reference;
 
+/* Classification bits of json_value.flags for J_NUMBER values, set with NUMBER_DECODING */
+#define JSON_NUMBER_DECODED 0x01  /* u.number.value was filled in by the parser */
+#define JSON_NUMBER_INTEGER 0x02  /* number has neither a fraction nor an exponent part */
+#define JSON_NUMBER_NEGATIVE 0x04 /* number starts with a minus sign */
+#define JSON_NUMBER_EXPONENT 0x08 /* number has an exponent part */
+#define JSON_NUMBER_OVERFLOW 0x10 /* integer does not fit int64_t */
+
+/**
+ * @brief Represents a JSON number as a reference to its text.
+ *
+ * The first two members mirror `reference`. When the library is built with
+ * NUMBER_DECODING the parser also decodes the value while validating the
+ * digits: integers that fit int64_t are stored in `value.integer`, and
+ * numbers on the exact fast path of json_get_double() in `value.real`. The
+ * JSON_NUMBER_* bits go to json_value.flags. Other numbers are classified but
+ * not decoded; the accessors convert their text when they are called. Without
+ * the flag the member is left out, so nodes stay as small as references.
+ */
+typedef struct json_number {
+  const char *ptr; /* Pointer to the start of the number in original input */
+  size_t len;      /* Length of the number text in bytes */
+#ifdef NUMBER_DECODING
+  union {
+    int64_t integer; /* Exact value when JSON_NUMBER_INTEGER is set and JSON_NUMBER_OVERFLOW is not */
+    double real;     /* Exactly rounded value otherwise */
+  } value;           /* Valid when JSON_NUMBER_DECODED is set in json_value.flags */
+#endif
+} json_number;
+
+/* Annotation bits of json_value.flags for J_STRING values */
+#define JSON_STRING_HAS_ESCAPES 0x01 /* string contains backslash escapes, see json_string_decode() */
+
+/* Returned by json_string_decode() for values it cannot decode */
+#define JSON_DECODE_ERROR ((size_t)-1)
+
 /* Forward declarations */
 typedef struct json_value json_value_type;
 typedef struct json_object json_object_type;
@@ -137,11 +189,13 @@ typedef struct json_object_node json_object_node_type;
  * input are stored to avoid memory allocation.
  */
 typedef struct json_value {
-  json_token type; /* Type discriminator determining active union member */
+  json_token type;   /* Type discriminator determining active union member */
+  uint8_t flags;     /* Parser annotations of the active member (JSON_STRING_* or JSON_NUMBER_* bits) */
+  uint8_t key_flags; /* JSON_STRING_* bits of the key of an object member; shares the padding after `type` */
   union {
     reference string;  /* String value (valid when type == J_STRING) */
     reference boolean; /* Boolean value (valid when type == J_BOOLEAN) */
-    reference number;  /* Number value (valid when type == J_NUMBER) */
+    json_number number; /* Number value (valid when type == J_NUMBER) */
     struct {
       json_array_node_type *last;  /* Pointer to last array element (for O(1) append) */
       json_array_node_type *items; /* Pointer to first array element (head of linked list) */
@@ -186,6 +240,114 @@ typedef struct json_array_node {
   json_array_node_type *next; /* Pointer to next node in the list (NULL for last) */
 } json_array_node;
 
+/**
+ * @brief Result of feeding a chunk to a `json_stream`.
+ */
+typedef enum {
+  JSON_STREAM_ERROR = 0, /* input is not valid JSON, or memory allocation failed */
+  JSON_STREAM_MORE = 1,  /* chunk consumed, the document is not complete yet */
+  JSON_STREAM_DONE = 2   /* the top-level value is complete */
+} json_stream_status;
+
+/**
+ * @brief Receives one document of a multi-document input.
+ *
+ * @param doc The parsed document; its nodes are recycled after the callback returns
+ * @param source The bytes of the document within the input
+ * @param user The pointer passed to the parsing function
+ * @return `true` to continue with the next document, `false` to stop
+ */
+typedef bool (*json_document_callback)(json_value *doc, reference source, void *user);
+
+/**
+ * @brief Callbacks of json_parse_events().
+ *
+ * Every member may be NULL to ignore that event. A callback returns `false`
+ * to stop parsing. Strings, keys and numbers are passed as temporary values
+ * that reference the input, so json_string_decode(), json_get_double() and
+ * json_get_int64() work on them; they are only valid during the call.
+ */
+typedef struct json_handler {
+  bool (*on_object_begin)(void *user);
+  bool (*on_object_end)(void *user);
+  bool (*on_array_begin)(void *user);
+  bool (*on_array_end)(void *user);
+  bool (*on_key)(const json_value *key, void *user);
+  bool (*on_string)(const json_value *value, void *user);
+  bool (*on_number)(const json_value *value, void *user);
+  bool (*on_boolean)(bool value, void *user);
+  bool (*on_null)(void *user);
+} json_handler;
+
+/* called from worker thread `worker` of json_parse_lines_parallel(); return false to stop that worker */
+typedef bool (*json_worker_callback)(json_value *doc, reference source, size_t worker, void *user);
+
+/* called from worker thread `worker` of json_parse_files() for file `index`; `doc` is NULL if the file could not be read or parsed */
+typedef bool (*json_file_callback)(json_value *doc, reference source, size_t index, size_t worker, void *user);
+
+typedef struct json_stream_block json_stream_block;
+
+/* compiled set of field paths for json_parse_projected() */
+typedef struct json_projection json_projection;
+
+/* node pools owning the tree built by json_parse_parallel() */
+typedef struct json_arena json_arena;
+
+/* read-only mapping of the input of json_parse_file() */
+typedef struct json_file json_file;
+
+/**
+ * @brief State of an incremental (push) parser.
+ *
+ * The stream keeps the open containers and the bytes of a token split across
+ * chunks between json_stream_feed() calls. Strings, numbers and keys of the
+ * tree are copied into an arena owned by the stream, so chunks can be reused
+ * as soon as json_stream_feed() returns. Nodes come from the same pools as the
+ * other parsers; do not call json_reset() while a document is being streamed.
+ */
+typedef struct json_stream {
+  json_value *root;          /* Tree being built */
+  json_value *current;       /* Slot waiting for a value, NULL between values */
+  json_value **stack;        /* Open containers, innermost last */
+  size_t capacity;           /* Allocated entries of stack */
+  int top;                   /* Index of the innermost open container, -1 when none */
+  uint8_t state;             /* Position in the grammar between tokens */
+  char *pending;             /* Carried bytes of a token split across chunks */
+  size_t pending_len;        /* Number of carried bytes */
+  size_t pending_cap;        /* Allocated size of pending */
+  bool escaped;              /* Carried string ends inside an escape sequence */
+  json_stream_block *blocks; /* Arena holding the bytes the tree references */
+  bool in_place;             /* Chunks outlive the tree: only split tokens are copied */
+} json_stream;
+
+/**
+ * @brief One segment of a buffer chain passed to json_parse_iov().
+ */
+typedef struct json_iovec {
+  const void *base; /* First byte of the segment */
+  size_t len;       /* Length of the segment in bytes */
+} json_iovec;
+
+#ifndef JSON_CURSOR_DEPTH
+#define JSON_CURSOR_DEPTH 0x400 /* Maximum nesting depth a json_cursor can enter (1024 levels) */
+#endif
+
+/**
+ * @brief State of an on-demand (pull) reader.
+ *
+ * The cursor reads one value per json_cursor_next() call and never allocates.
+ * Only the kind of each open container is kept, one bit per level.
+ */
+typedef struct json_cursor {
+  const char *ptr;                            /* Next unread byte */
+  const char *end;                            /* End of the input */
+  size_t depth;                               /* Number of open containers */
+  bool first;                                 /* Innermost container has no element read yet */
+  bool started;                               /* Root value has been read */
+  bool failed;                                /* Input was found to be invalid */
+  uint64_t objects[JSON_CURSOR_DEPTH / 64];   /* Bit set for each open object */
+} json_cursor;
+
 /**
  * @brief Parses a JSON string and creates a tree of `json_value` objects.
  *
@@ -214,21 +376,458 @@ bool json_parse(const char *s, const char *end, json_value *root);
  */
 bool json_parse_iterative(const char *s, const char *end, json_value *root);
 
+/**
+ * @brief Parses a writable JSON buffer iteratively, decoding strings in place.
+ *
+ * Works like json_parse_iterative(), but every string and object key with
+ * escape sequences is unescaped inside the input buffer right after it is
+ * scanned; the decoded form is never longer than the source. All references
+ * then point at final UTF-8 bytes and JSON_STRING_HAS_ESCAPES is left clear.
+ * The buffer is modified even if parsing fails, and json_print() or
+ * json_stringify() of the result no longer re-escape those strings.
+ *
+ * @param s The writable JSON buffer to parse
+ * @param end Pointer one past the last byte of the buffer
+ * @param root A pointer to root `json_value` where parsed JSON will be stored
+ * @return `true` if JSON was successfully parsed, `false` otherwise
+ */
+bool json_parse_in_situ(char *s, const char *end, json_value *root);
+
+/**
+ * @brief Parses a JSON buffer followed by JSON_PADDING zero bytes.
+ *
+ * Works like json_parse_iterative(), but relies on the padding to drop
+ * per-byte bounds checks: whitespace skipping stops at the zero byte at `end`,
+ * and the string and number kernels keep loading full vectors up to the end
+ * of the input instead of falling back to scalar tails. Bounds are checked
+ * only at structural boundaries. Use json_padded_buffer() to get such a
+ * buffer.
+ *
+ * @param s The JSON text to parse
+ * @param end Pointer one past the last byte of JSON text, followed by
+ *            JSON_PADDING readable zero bytes
+ * @param root A pointer to root `json_value` where parsed JSON will be stored
+ * @return `true` if JSON was successfully parsed, `false` otherwise (also
+ *         when the padding is not zeroed)
+ */
+bool json_parse_padded(const char *s, const char *end, json_value *root);
+
+/**
+ * @brief Copies a JSON text into a new buffer with JSON_PADDING zero bytes appended.
+ *
+ * @param s The JSON text to copy
+ * @param len The length of the JSON text in bytes
+ * @return A buffer for json_parse_padded() that the caller releases with
+ *         free(), or NULL if memory allocation fails
+ */
+char *json_padded_buffer(const char *s, size_t len);
+
+/**
+ * @brief Parses a JSON string like json_parse_iterative() and reports where it failed.
+ *
+ * The success path is json_parse_iterative() itself. Only after a failure is
+ * the input scanned again by the allocation-free validator to find the error
+ * code and the offending byte, and the newlines before it are counted to give
+ * the line and column. Well-formed input that did not fit the node pools is
+ * reported as E_NO_MEMORY_OBJECT or E_NO_MEMORY_ARRAY at offset 0.
+ *
+ * @param s The JSON text to parse
+ * @param end Pointer one past the last byte of JSON text
+ * @param root A pointer to root `json_value` where parsed JSON will be stored
+ * @param result Receives the error code and location; zeroed on success
+ * @return `true` if JSON was successfully parsed, `false` otherwise
+ */
+bool json_parse_located(const char *s, const char *end, json_value *root, json_result *result);
+
+/**
+ * @brief Parses JSON into a sequence of callbacks without building a tree.
+ *
+ * Uses the scanning kernels of json_parse_iterative() but allocates no nodes
+ * and leaves the node pools untouched; open containers are tracked with one
+ * bit per level, so only the nesting depth (JSON_STACK_SIZE) is limited.
+ * Events arrive in document order: each key precedes its value, each
+ * container is bracketed by its begin and end events.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param handler The callbacks to invoke
+ * @param user Pointer passed through to every callback
+ * @return `true` if the input is valid JSON and no callback stopped parsing,
+ *         `false` otherwise (events already delivered are not undone)
+ */
+bool json_parse_events(const char *s, const char *end, const json_handler *handler, void *user);
+
+/**
+ * @brief Starts reading a document on demand.
+ *
+ * @param c The cursor to initialize
+ * @param s The input buffer; it must outlive the values read from it
+ * @param end Pointer one past the last byte of the input
+ */
+void json_cursor_init(json_cursor *c, const char *s, const char *end);
+
+/**
+ * @brief Reads the next element of the innermost open container.
+ *
+ * The first call reads the root, which must be an object or an array.
+ * Scalars are parsed into `value`. An object or array is returned with no
+ * items and is entered: following calls read its elements, or
+ * json_cursor_skip() jumps over the rest of it.
+ *
+ * @param c The cursor
+ * @param key If not NULL, receives the raw (still escaped) key inside an
+ *            object, or a NULL reference inside an array; its JSON_STRING_*
+ *            bits are left in `value->key_flags`
+ * @param value Receives the element
+ * @return `true` if an element was read, `false` at the end of the innermost
+ *         container (which is then left) or on invalid input (`c->failed`)
+ */
+bool json_cursor_next(json_cursor *c, reference *key, json_value *value);
+
+/**
+ * @brief Reads forward to a field of the innermost open object.
+ *
+ * Fields before the match are passed over, object and array values with
+ * json_cursor_skip(). Keys are compared in their raw (escaped) form and the
+ * search never looks back, so read fields in document order.
+ *
+ * @param c The cursor, positioned inside an object
+ * @param key The key to look for
+ * @param len Length of `key` in bytes
+ * @param value Receives the value of the field, entered if it is a container
+ * @return `true` if the field was found, `false` if the object ended (and was
+ *         left), the innermost container is not an object, or on invalid input
+ */
+bool json_cursor_find_field(json_cursor *c, const char *key, size_t len, json_value *value);
+
+/**
+ * @brief Leaves the innermost open container without parsing the rest of it.
+ *
+ * The unread part is jumped over with an SSE2 bracket-matching scan that
+ * steps over strings; it is not validated.
+ *
+ * @param c The cursor
+ * @return `true` if a container was left, `false` if none is open or its
+ *         closing bracket is missing
+ */
+bool json_cursor_skip(json_cursor *c);
+
+/**
+ * @brief Finds the end of the value that starts at `s` without parsing it.
+ *
+ * Objects and arrays are matched by counting brackets outside strings, 16
+ * bytes at a time with SSE2; strings are scanned to their closing quote and
+ * literals are checked exactly. Nothing else is validated, so the result is
+ * only meaningful for valid input. Useful to slice raw sub-documents or to
+ * index large inputs without building a tree.
+ *
+ * @param s Start of the value; leading whitespace is skipped
+ * @param end Pointer one past the last byte of the input
+ * @return Pointer one past the last byte of the value, or NULL if the value
+ *         is not terminated within the input
+ */
+const char *json_skip_value(const char *s, const char *end);
+
+/**
+ * @brief Parses only the value a JSON Pointer (RFC 6901) refers to.
+ *
+ * The input is read with a json_cursor: values before the target are
+ * skipped without building nodes and reading stops once the target is
+ * complete, so nothing after it is examined. A scalar target is returned
+ * without touching the node pools; an object or array target is parsed
+ * like json_parse_iterative() into nodes of its own subtree only.
+ * Keys written with JSON escapes are decoded before they are compared, so
+ * `"a\u0062"` matches the token `ab`.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param pointer NUL-terminated pointer such as "/data/items/3/id"; "" is
+ *                the whole document, which must then end with its root
+ * @param out Receives the target value
+ * @return `true` if the target exists and was parsed, `false` otherwise
+ */
+bool json_parse_pointer(const char *s, const char *end, const char *pointer, json_value *out);
+
+/**
+ * @brief Compiles field paths for json_parse_projected().
+ *
+ * A path is a sequence of segments: a key (`user`), `.key` after another
+ * segment, `[*]` for every element of an array or `[n]` for element `n`,
+ * as in `entities.hashtags[*].text`. Keys end at `.` or `[` and are compared
+ * with the raw (escaped) keys of the input. The empty path selects the whole
+ * document. The paths are copied.
+ *
+ * @param paths The paths to select
+ * @param count Number of paths
+ * @return The compiled set, or NULL if a path is malformed or memory runs out;
+ *         release it with json_projection_free()
+ */
+json_projection *json_projection_compile(const char *const *paths, size_t count);
+
+/**
+ * @brief Releases a compiled path set.
+ *
+ * @param projection The set to release, may be NULL
+ */
+void json_projection_free(json_projection *projection);
+
+/**
+ * @brief Parses only the selected paths of a document.
+ *
+ * The document is read with a json_cursor. Nodes are created only for
+ * values on a selected path: the selected values (whole subtrees, built by
+ * the iterative parser) and the objects and arrays leading to them, which
+ * hold just the matching members in input order. An array reached through
+ * `[n]` holds only that element. Ancestors stay in the tree even if nothing
+ * below them matched. Everything else is passed over with the
+ * bracket-counting scan of json_skip_value() and is not validated.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param projection Paths compiled with json_projection_compile()
+ * @param root Receives the projected tree
+ * @return `true` on success, `false` on invalid input or exhausted node pools
+ */
+bool json_parse_projected(const char *s, const char *end, const json_projection *projection, json_value *root);
+
+/**
+ * @brief Initializes an incremental parser that builds its tree into `root`.
+ *
+ * @param ctx The stream state to initialize
+ * @param root A pointer to root `json_value` where parsed JSON will be stored
+ */
+void json_stream_init(json_stream *ctx, json_value *root);
+
+/**
+ * @brief Feeds the next chunk of a JSON document to an incremental parser.
+ *
+ * Chunks may split the document anywhere, including inside strings, numbers,
+ * literals and escape sequences. The resulting tree is the same as the one
+ * json_parse_iterative() builds for the concatenated input; whitespace after
+ * the document is accepted. While a token is split, each chunk is only
+ * scanned for the end of the token and the carried bytes are parsed once it
+ * has arrived, so the cost stays linear however small the chunks are.
+ *
+ * @param ctx The stream state
+ * @param chunk The next bytes of the document (not referenced after the call)
+ * @param len The length of the chunk in bytes
+ * @return JSON_STREAM_MORE while the document is incomplete, JSON_STREAM_DONE
+ *         once it is complete, JSON_STREAM_ERROR on invalid input (the stream
+ *         then stays failed)
+ */
+json_stream_status json_stream_feed(json_stream *ctx, const char *chunk, size_t len);
+
+/**
+ * @brief Releases the memory of an incremental parser.
+ *
+ * The strings, numbers and keys of the tree live in the stream arena, so the
+ * tree must not be used after this call.
+ *
+ * @param ctx The stream state to release
+ */
+void json_stream_free(json_stream *ctx);
+
+/**
+ * @brief Parses a document held in a chain of buffers without coalescing it.
+ *
+ * The segments are fed to an incremental parser that references strings,
+ * numbers and keys inside the segments. Only tokens that straddle a segment
+ * boundary are stitched together in a side buffer and copied into the stream
+ * arena, so the segments and `ctx` must both outlive the tree. A token spread
+ * over many segments is scanned once, not again for every segment.
+ *
+ * @param iov The segments, in order
+ * @param count Number of segments
+ * @param root Receives the tree
+ * @param ctx Stream state owning the stitched tokens; release it with
+ *            json_stream_free() when the tree is no longer used, also after
+ *            a failure
+ * @return `true` if the segments hold exactly one valid document
+ */
+bool json_parse_iov(const json_iovec *iov, int count, json_value *root, json_stream *ctx);
+
+/**
+ * @brief Parses newline-delimited JSON (NDJSON / JSON Lines) documents.
+ *
+ * Records are split with an SSE2 newline scan; a raw newline cannot occur
+ * inside a JSON string, so every newline is a record boundary. Surrounding
+ * whitespace (including `\r`) and blank lines are skipped. Each record is
+ * parsed like json_parse_iterative() and handed to `cb`; the node pools are
+ * recycled with json_reset() before the next record.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param cb Callback invoked for every document
+ * @param user Pointer passed through to `cb`
+ * @param count If not NULL, receives the number of documents delivered
+ * @return `true` if every record was parsed and delivered, `false` if a
+ *         record is invalid (it is record number `*count`) or `cb` stopped
+ */
+bool json_parse_lines(const char *s, const char *end, json_document_callback cb, void *user, size_t *count);
+
+/**
+ * @brief Parses newline-delimited JSON on several threads.
+ *
+ * The input is cut into `threads` chunks of about equal size, each ending on
+ * a newline, and every chunk is parsed like json_parse_lines() on its own
+ * thread with its own node pools and depth stack. `cb` runs on the worker
+ * thread and receives the worker index; worker `i` owns the records that
+ * precede those of worker `i + 1`, so ordered output can be merged by
+ * worker index (or by `source.ptr`). Trees are only valid inside `cb`.
+ * With `threads` of 0 or 1 the input is parsed on the calling thread.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param threads Number of worker threads
+ * @param cb Callback invoked for every document, concurrently across workers
+ * @param user Pointer passed through to `cb`
+ * @param count If not NULL, receives the number of documents delivered
+ * @return `true` if every chunk was parsed and delivered, `false` if a record
+ *         is invalid or `cb` stopped a worker; a failing worker does not stop
+ *         the others
+ */
+bool json_parse_lines_parallel(const char *s, const char *end, size_t threads, json_worker_callback cb, void *user, size_t *count);
+
+/**
+ * @brief Parses back-to-back documents such as `{...}{...}` or RFC 7464 JSON
+ * text sequences.
+ *
+ * Document boundaries are found structurally: each document is parsed like
+ * json_parse_iterative() up to the bracket that closes its root, and the
+ * next one starts after any whitespace and record separator (0x1E) bytes,
+ * so the input is read once. Each document is handed to `cb`; `source` spans
+ * its text, so `source.ptr + source.len - s` is its end offset. The node
+ * pools are recycled with json_reset() before the next document.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param cb Callback invoked for every document
+ * @param user Pointer passed through to `cb`
+ * @param count If not NULL, receives the number of documents delivered
+ * @return `true` if the whole input was parsed and delivered, `false` if a
+ *         document is invalid (it is document number `*count`) or `cb` stopped
+ */
+bool json_parse_documents(const char *s, const char *end, json_document_callback cb, void *user, size_t *count);
+
+/**
+ * @brief Parses the elements of a top-level array one at a time.
+ *
+ * Meant for exports of the form `[{...}, {...}, ...]` with more values in
+ * total than the node pools hold. Each element is parsed like
+ * json_parse_iterative(), handed to `cb` and its nodes are recycled with
+ * json_reset(), so only the largest element has to fit in the pools. Map
+ * huge files into memory and pass the mapping as the buffer.
+ *
+ * @param s The input buffer, starting with `[`
+ * @param end Pointer one past the last byte of the input
+ * @param cb Callback invoked for every element; `source` spans its text
+ * @param user Pointer passed through to `cb`
+ * @param count If not NULL, receives the number of elements delivered
+ * @return `true` if the whole array was parsed and delivered, `false` on
+ *         invalid input or if `cb` stopped
+ */
+bool json_parse_array_elements(const char *s, const char *end, json_document_callback cb, void *user, size_t *count);
+
+/**
+ * @brief Parses one large document on several threads.
+ *
+ * A structural pass walks the members of the root object or array with the
+ * bracket-counting scan of json_skip_value() and cuts them into `threads`
+ * runs of about equal size. Each run is parsed on its own thread into its
+ * own node pools, then the member lists are linked in input order, so the
+ * resulting tree is the one json_parse_iterative() builds. The nodes belong
+ * to `*arena` instead of the shared pools: they survive json_reset() and
+ * each thread can hold JSON_VALUE_POOL_SIZE nodes of each kind. Speed-up
+ * requires a root with many members.
+ *
+ * @param s The input buffer
+ * @param end Pointer one past the last byte of the input
+ * @param threads Number of threads; 0 or 1 parses on the calling thread
+ * @param root Receives the tree
+ * @param arena Receives the pools of the tree; release them with
+ *              json_arena_free() when the tree is no longer used
+ * @return `true` on success, `false` on invalid input or exhausted pools
+ */
+bool json_parse_parallel(const char *s, const char *end, size_t threads, json_value *root, json_arena **arena);
+
+/**
+ * @brief Releases the node pools of a tree built by json_parse_parallel().
+ *
+ * @param arena The pools to release, may be NULL
+ */
+void json_arena_free(json_arena *arena);
+
+/**
+ * @brief Parses a file without copying it.
+ *
+ * The file is mapped read-only (mmap() with MADV_SEQUENTIAL and
+ * MADV_HUGEPAGE hints, MapViewOfFile() on Windows) and parsed like
+ * json_parse_iterative() in place, so the references of the tree point into
+ * the page cache. Trailing whitespace after the root is ignored.
+ *
+ * @param path Path of the file
+ * @param root Receives the tree
+ * @param file Receives the mapping the tree references; release it with
+ *             json_file_close() once the tree is no longer used
+ * @return `true` on success, `false` if the file cannot be mapped (empty
+ *         files included) or is not valid JSON
+ */
+bool json_parse_file(const char *path, json_value *root, json_file **file);
+
+/**
+ * @brief Unmaps a file opened by json_parse_file().
+ *
+ * @param file The mapping to release, may be NULL
+ */
+void json_file_close(json_file *file);
+
+/**
+ * @brief Reads and parses many files on a pool of threads.
+ *
+ * Worker `w` handles files `w`, `w + threads`, ... with blocking pread()
+ * calls into a buffer it reuses, so the reads of some workers overlap the
+ * parsing of others. Each file is parsed like json_parse_iterative() with
+ * the padded kernels of json_parse_padded(), on the worker's own node pools,
+ * and handed to `cb`; trailing whitespace is ignored. Trees and sources are
+ * only valid inside `cb`.
+ *
+ * @param paths The files to parse
+ * @param count Number of paths
+ * @param threads Number of worker threads, at most one per file
+ * @param cb Callback invoked once for every file, concurrently across workers
+ * @param user Pointer passed through to `cb`
+ * @return `true` if every file was parsed and `cb` never stopped a worker
+ */
+bool json_parse_files(const char *const *paths, size_t count, size_t threads, json_file_callback cb, void *user);
+
 /**
  * @brief Validates a JSON string without allocating memory for parsed tree.
  *
  * This function performs syntax validation only, checking if the JSON is well-formed
- * without constructing the full in-memory representation. It's optimized for
- * scenarios where only validation is needed, not parsing.
+ * without constructing the full in-memory representation. Open containers are tracked
+ * on a bit stack (one bit per nesting level), so the node pools are never touched:
+ * documents of any size validate, and the pools of the calling thread are left as they
+ * were. Only the nesting depth is limited, to JSON_STACK_SIZE levels; deeper input
+ * returns E_NO_MEMORY_OBJECT or E_NO_MEMORY_ARRAY.
  *
- * @param s A pointer to const char* pointer representing JSON string to validate.
- *            The pointer may be advanced during validation (pass by pointer to pointer).
- * @param len The length of JSON string in bytes
+ * @param s Pointer to the first byte of the JSON text.
+ * @param end Pointer to one past the last byte.
  * @return E_OK if string is valid JSON, non-zero error code otherwise.
  *         The error code indicates the type of validation failure.
  */
 json_error json_validate(const char *s, const char *end);
 
+/**
+ * @brief Validates a JSON string like json_validate() and reports where it failed.
+ *
+ * @param s Pointer to the first byte of the JSON text.
+ * @param end Pointer to one past the last byte.
+ * @param result Receives the error code, the byte offset of the offending byte
+ *               or token and its line and column; zeroed on success
+ * @return E_OK if string is valid JSON, the error code stored in result otherwise.
+ */
+json_error json_validate_located(const char *s, const char *end, json_result *result);
+
 /**
  * @brief Compares two JSON values for structural and value equality.
  *
@@ -272,6 +871,8 @@ void json_reset(void);
  * This function completely resets the internal memory management system,
  * clearing all allocated JSON structures. Unlike json_reset(), this actually
  * clears the memory contents, not just the allocation pointers.
+ * It also releases the heap part of the parse depth stack, which otherwise
+ * grows on demand and is kept between calls.
  * Use this when you want to ensure all previously parsed data is inaccessible.
  */
 void json_cleanup(void);
@@ -301,6 +902,94 @@ void json_free(json_value *v);
  */
 void json_print(const json_value *v, FILE *out);
 
+/**
+ * @brief Converts a JSON number to a double.
+ *
+ * Numbers with at most 19 significant digits, a mantissa below 2^53 and a
+ * decimal exponent within [-22, 22] are converted with a single exactly
+ * rounded multiplication or division (Clinger's fast path). Other numbers
+ * fall back to a locale-independent strtod() call. Values decoded by the
+ * parser (NUMBER_DECODING) are returned without touching the text.
+ *
+ * @param v The json_value to convert (must be of type J_NUMBER)
+ * @param out Receives the converted value
+ * @return true on success, false if v is not a number or the value overflows a double
+ */
+bool json_get_double(const json_value *v, double *out);
+
+/**
+ * @brief Converts an integral JSON number to a signed 64-bit integer.
+ *
+ * @param v The json_value to convert (must be of type J_NUMBER)
+ * @param out Receives the converted value
+ * @return true on success, false if v is not a number, has a fraction or
+ *         exponent part, or does not fit into int64_t
+ */
+bool json_get_int64(const json_value *v, int64_t *out);
+
+/**
+ * @brief Converts an integral JSON number to an unsigned 64-bit integer.
+ *
+ * @param v The json_value to convert (must be of type J_NUMBER)
+ * @param out Receives the converted value
+ * @return true on success, false if v is not a number, is negative, has a
+ *         fraction or exponent part, or does not fit into uint64_t
+ */
+bool json_get_uint64(const json_value *v, uint64_t *out);
+
+/**
+ * @brief Converts the leading elements of a JSON array of numbers to doubles.
+ *
+ * @param array The J_ARRAY json_value whose elements are converted
+ * @param out Output buffer with room for count values
+ * @param count Maximum number of elements to convert
+ * @return The number of converted elements; conversion stops at the first
+ *         element that is not a number or cannot be converted
+ */
+size_t json_get_doubles(const json_value *array, double *out, size_t count);
+
+/**
+ * @brief Converts the leading elements of a JSON array of integers to int64_t.
+ *
+ * @param array The J_ARRAY json_value whose elements are converted
+ * @param out Output buffer with room for count values
+ * @param count Maximum number of elements to convert
+ * @return The number of converted elements; conversion stops at the first
+ *         element that json_get_int64() rejects
+ */
+size_t json_get_int64s(const json_value *array, int64_t *out, size_t count);
+
+/**
+ * @brief Decodes the escape sequences of a string value into UTF-8.
+ *
+ * String references point at the raw input, escapes included. Strings the
+ * parser saw without a backslash (JSON_STRING_HAS_ESCAPES clear) are copied
+ * as is; the rest are copied up to each backslash with SSE2 and the escapes
+ * are expanded, `\uXXXX` surrogate pairs included. Lone surrogates decode
+ * to U+FFFD. Object keys are decoded with json_key_decode().
+ *
+ * @param v The J_STRING value to decode
+ * @param dst Output buffer of at least `v->u.string.len` bytes; the decoded
+ *            form is never longer than the source and is not NUL-terminated
+ * @return The number of bytes written, or JSON_DECODE_ERROR if v is not a
+ *         string or contains an invalid escape sequence
+ */
+size_t json_string_decode(const json_value *v, char *dst);
+
+/**
+ * @brief Decodes the escape sequences of an object key into UTF-8.
+ *
+ * Works like json_string_decode() on `item->key`, using the
+ * JSON_STRING_HAS_ESCAPES bit the parser left in `item->value.key_flags`.
+ *
+ * @param item The object member whose key to decode
+ * @param dst Output buffer of at least `item->key.len` bytes; the decoded
+ *            form is never longer than the source and is not NUL-terminated
+ * @return The number of bytes written, or JSON_DECODE_ERROR if the key
+ *         contains an invalid escape sequence
+ */
+size_t json_key_decode(const json_object *item, char *dst);
+
 /**
  * @brief Returns a human-readable string description for a JSON error code.
  *
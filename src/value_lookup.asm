@@ -0,0 +1,24 @@
+/* First-byte dispatch table for JSON values
+ * 1 '{' object, 2 '[' array, 3 '"' string,
+ * 4 't' true, 5 'f' false, 6 'n' null,
+ * 7 '-' and '0'-'9' number, 0 anything else
+ */
+.section .rodata
+.global value_lookup
+value_lookup:
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 0-15 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 16-31 */
+.byte 0,0,3,0,0,0,0,0,0,0,0,0,0,7,0,0  /* 32-47 ('"'=34, '-'=45) */
+.byte 7,7,7,7,7,7,7,7,7,7,0,0,0,0,0,0  /* 48-63 ('0'-'9') */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 64-79 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0  /* 80-95 ('['=91) */
+.byte 0,0,0,0,0,0,5,0,0,0,0,0,0,0,6,0  /* 96-111 ('f'=102, 'n'=110) */
+.byte 0,0,0,0,4,0,0,0,0,0,0,1,0,0,0,0  /* 112-127 ('t'=116, '{'=123) */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 128-143 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 144-159 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 160-175 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 176-191 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 192-207 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 208-223 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 224-239 */
+.byte 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* 240-255 */
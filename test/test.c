@@ -14,11 +14,47 @@ extern void test_string_escape_printing_coverage(void);
 extern void test_print_value_compact_coverage(void);
 extern void test_print_value_all_types_coverage(void);
 extern void test_json_stringify_buffer_error_coverage(void);
+extern void test_value_dispatch_literals_coverage(void);
+extern void test_parse_stack_growth_coverage(void);
 extern void test_free_array_node_coverage(void);
 extern void test_parse_string_full_coverage(void);
+extern void test_parse_string_control_characters(void);
+extern void test_utf8_validation_valid(void);
+extern void test_utf8_validation_invalid(void);
+extern void test_json_get_double(void);
+extern void test_json_get_double_random(void);
+extern void test_json_get_int64(void);
+extern void test_json_get_doubles(void);
+extern void test_json_number_decoding(void);
+extern void test_json_string_decode(void);
+extern void test_json_parse_in_situ(void);
+extern void test_json_key_decode(void);
+extern void test_json_parse_padded(void);
+extern void test_json_stream_feed(void);
+extern void test_json_parse_iov(void);
+extern void test_json_stream_long_token(void);
+extern void test_json_parse_lines(void);
+extern void test_json_parse_documents(void);
+extern void test_json_parse_lines_parallel(void);
+extern void test_json_parse_events(void);
+extern void test_json_parse_events_unbounded(void);
+extern void test_json_cursor(void);
+extern void test_json_skip_value(void);
+extern void test_json_parse_pointer(void);
+extern void test_json_parse_pointer_escaped_keys(void);
+extern void test_json_parse_pointer_whole_document_trailing(void);
+extern void test_json_parse_projected(void);
+extern void test_json_projection_overlap(void);
+extern void test_json_parse_array_elements(void);
+extern void test_json_parse_parallel(void);
+extern void test_json_parse_file(void);
+extern void test_json_parse_files(void);
 extern void test_parse_hex4(void);
 extern void test_json_error_string_function(void);
 extern void test_json_error_string_with_validate(void);
+extern void test_json_validate_located(void);
+extern void test_json_parse_located(void);
+extern void test_json_parse_located_pool(void);
 
 #define LCPRN_RAND_MULTIPLIER 1664525
 #define LCPRN_RAND_INCREMENT 1013904223
@@ -410,6 +446,89 @@ TEST(test_invalid_iterative_array_of_unclosed_objects) {
   END_TEST;
 }
 
+TEST(test_reset_pool_links) {
+  /* nodes recycled by json_reset() must not keep the sibling links of the previous tree */
+  const char *first_array = "[1,2,3]";
+  const char *second_array = "[4]";
+  const char *first_object = "{\"a\":1,\"b\":2}";
+  const char *second_object = "{\"c\":3}";
+  json_value v;
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(first_array, first_array + strlen(first_array), &v));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(second_array, second_array + strlen(second_array), &v));
+  ASSERT_PTR_NULL(v.u.array.items->next);
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(first_array, first_array + strlen(first_array), &v));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(second_array, second_array + strlen(second_array), &v));
+  ASSERT_PTR_NULL(v.u.array.items->next);
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(first_object, first_object + strlen(first_object), &v));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(second_object, second_object + strlen(second_object), &v));
+  ASSERT_PTR_NULL(v.u.object.items->next);
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(first_object, first_object + strlen(first_object), &v));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(second_object, second_object + strlen(second_object), &v));
+  ASSERT_PTR_NULL(v.u.object.items->next);
+  json_reset();
+  END_TEST;
+}
+
+TEST(test_invalid_truncated_unicode_escape) {
+  /* the input ends after three hex digits; a heap copy without a terminator lets ASan catch a read past end */
+  const char *text = "[\"\\u123";
+  size_t len = strlen(text);
+  char *source = (char *)malloc(len);
+  json_value v;
+  ASSERT_PTR_NOT_NULL(source);
+  memcpy(source, text, len);
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse(source, source + len, &v));
+  json_free(&v);
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(source, source + len, &v));
+  json_free(&v);
+  ASSERT_NOT_EQUAL(json_validate(source, source + len), E_OK, json_error);
+  free(source);
+  END_TEST;
+}
+
+TEST(test_array_pool_exhausted) {
+  /* one element more than the array pool holds must fail, not return a truncated tree */
+  size_t count = JSON_VALUE_POOL_SIZE + 1;
+  size_t len = 0;
+  size_t i;
+  json_value v;
+  char *source = (char *)malloc(count * 2 + 1);
+  ASSERT_PTR_NOT_NULL(source);
+  source[len++] = '[';
+  for (i = 0; i < count; i++) {
+    source[len++] = '0';
+    source[len++] = ',';
+  }
+  source[len - 1] = ']';
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse(source, source + len, &v));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(source, source + len, &v));
+  json_reset();
+  free(source);
+  END_TEST;
+}
+
 TEST(test_valid_number_zero_point_zero_iterative) {
   char *json;
 
@@ -6021,6 +6140,33 @@ TEST(test_validate_no_error) {
   END_TEST;
 }
 
+TEST(test_validate_unbounded) {
+  /* more members than the node pools hold: the validator keeps no nodes */
+  size_t count = JSON_VALUE_POOL_SIZE * 2;
+  size_t len = 0;
+  size_t i;
+  json_value value;
+  const char *small = "[1,{\"a\":2}]";
+  char *source = (char *)malloc(count * 8 + 2);
+  ASSERT_PTR_NOT_NULL(source);
+  source[len++] = '{';
+  for (i = 0; i < count; i++) {
+    len += (size_t)sprintf(source + len, "\"%03u\":1,", (unsigned)(i % 1000));
+  }
+  source[len - 1] = '}';
+  json_reset();
+  ASSERT_EQUAL(json_validate(source, source + len), E_OK, json_error);
+  source[len - 1] = ',';
+  ASSERT_EQUAL(json_validate(source, source + len), E_INVALID_JSON, json_error);
+  free(source);
+  /* the pools are untouched, so a parse afterwards still has room */
+  memset(&value, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(small, small + strlen(small), &value));
+  json_free(&value);
+  json_reset();
+  END_TEST;
+}
+
 TEST(test_randomization) {
   const char *test_cases[] = {
       "[]",
@@ -8085,6 +8231,9 @@ int main(int argc, char *argv[]) {
   RUN_TEST(test_invalid_iterative_single_value_no_array_or_object);
   RUN_TEST(test_invalid_iterative_nested_unclosed_array);
   RUN_TEST(test_invalid_iterative_array_of_unclosed_objects);
+  RUN_TEST(test_reset_pool_links);
+  RUN_TEST(test_invalid_truncated_unicode_escape);
+  RUN_TEST(test_array_pool_exhausted);
   RUN_TEST(test_valid_number_zero_point_zero);
   RUN_TEST(test_valid_number_zero_point_zero_iterative);
   RUN_TEST(test_invalid_iterative_truncated_exponent);
@@ -8440,6 +8589,7 @@ int main(int argc, char *argv[]) {
   RUN_TEST(test_validate_expected_object_element);
   RUN_TEST(test_validate_expected_object_element_null);
   RUN_TEST(test_validate_no_error);
+  RUN_TEST(test_validate_unbounded);
   RUN_TEST(test_randomization);
   RUN_TEST(test_json_cleanup);
   RUN_TEST(test_replacement);
@@ -8487,9 +8637,45 @@ int main(int argc, char *argv[]) {
   RUN_TEST(test_print_value_compact_coverage);
   RUN_TEST(test_print_value_all_types_coverage);
   RUN_TEST(test_json_stringify_buffer_error_coverage);
+  RUN_TEST(test_value_dispatch_literals_coverage);
+  RUN_TEST(test_parse_stack_growth_coverage);
   RUN_TEST(test_parse_string_full_coverage);
+  RUN_TEST(test_parse_string_control_characters);
+  RUN_TEST(test_utf8_validation_valid);
+  RUN_TEST(test_utf8_validation_invalid);
+  RUN_TEST(test_json_get_double);
+  RUN_TEST(test_json_get_double_random);
+  RUN_TEST(test_json_get_int64);
+  RUN_TEST(test_json_get_doubles);
+  RUN_TEST(test_json_number_decoding);
+  RUN_TEST(test_json_string_decode);
+  RUN_TEST(test_json_parse_in_situ);
+  RUN_TEST(test_json_key_decode);
+  RUN_TEST(test_json_parse_padded);
+  RUN_TEST(test_json_stream_feed);
+  RUN_TEST(test_json_parse_iov);
+  RUN_TEST(test_json_stream_long_token);
+  RUN_TEST(test_json_parse_lines);
+  RUN_TEST(test_json_parse_documents);
+  RUN_TEST(test_json_parse_lines_parallel);
+  RUN_TEST(test_json_parse_events);
+  RUN_TEST(test_json_parse_events_unbounded);
+  RUN_TEST(test_json_cursor);
+  RUN_TEST(test_json_skip_value);
+  RUN_TEST(test_json_parse_pointer);
+  RUN_TEST(test_json_parse_pointer_escaped_keys);
+  RUN_TEST(test_json_parse_pointer_whole_document_trailing);
+  RUN_TEST(test_json_parse_projected);
+  RUN_TEST(test_json_projection_overlap);
+  RUN_TEST(test_json_parse_array_elements);
+  RUN_TEST(test_json_parse_parallel);
+  RUN_TEST(test_json_parse_file);
+  RUN_TEST(test_json_parse_files);
   RUN_TEST(test_parse_hex4);
   RUN_TEST(test_json_error_string_function);
   RUN_TEST(test_json_error_string_with_validate);
+  RUN_TEST(test_json_validate_located);
+  RUN_TEST(test_json_parse_located);
+  RUN_TEST(test_json_parse_located_pool);
   TEST_FINALIZE;
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+typedef struct {
+  size_t elements;
+  size_t stop_after;
+  int64_t sum;
+  size_t source_bytes;
+} elements_state;
+
+static bool sum_element(json_value *element, reference source, void *user) {
+  elements_state *state = (elements_state *)user;
+  int64_t id;
+  state->source_bytes += source.len;
+  if (element->type == J_OBJECT && element->u.object.items && json_get_int64(&element->u.object.items->item.value, &id))
+    state->sum += id;
+  return ++state->elements != state->stop_after;
+}
+
+TEST(test_json_parse_array_elements) {
+  /* more nodes in total than the pools hold, a few per element */
+  size_t total = JSON_VALUE_POOL_SIZE;
+  char *source = (char *)malloc(total * 48 + 2);
+  size_t len = 0;
+  size_t i;
+  size_t count;
+  elements_state state;
+  json_value root;
+  ASSERT_PTR_NOT_NULL(source);
+  source[len++] = '[';
+  for (i = 1; i <= total; i++)
+    len += (size_t)sprintf(source + len, "%s{\"id\": %u, \"tags\": [1, 2, 3]}", i > 1 ? ", " : "", (unsigned)i);
+  source[len++] = ']';
+  memset(&root, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(source, source + len, &root));
+  json_reset();
+
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_array_elements(source, source + len, sum_element, &state, &count));
+  ASSERT_EQ(count, total);
+  ASSERT_TRUE(state.sum == (int64_t)total * (int64_t)(total + 1) / 2);
+  ASSERT_EQ(state.source_bytes, len - 2 - (total - 1) * 2);
+
+  /* the callback stops the walk */
+  memset(&state, 0, sizeof(state));
+  state.stop_after = 10;
+  ASSERT_FALSE(json_parse_array_elements(source, source + len, sum_element, &state, &count));
+  ASSERT_EQ(count, 10);
+  free(source);
+
+  /* scalar elements, empty arrays */
+  const char *mixed = "[1, \"two\", true, null, [], {}]";
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_array_elements(mixed, mixed + strlen(mixed), sum_element, &state, &count));
+  ASSERT_EQ(count, 6);
+  ASSERT_EQ(state.source_bytes, 1 + 5 + 4 + 4 + 2 + 2);
+  ASSERT_TRUE(json_parse_array_elements("[]", "[]" + 2, sum_element, &state, &count));
+  ASSERT_EQ(count, 0);
+
+  /* invalid input */
+  const char *invalid[] = {"{\"a\": 1}", "[{\"a\": }]", "[1, 2", "[1 2]", "[1] ", "[[1]]]"};
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    ASSERT_FALSE(json_parse_array_elements(invalid[i], invalid[i] + strlen(invalid[i]), sum_element, &state, &count));
+  END_TEST;
+}
@@ -0,0 +1,109 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+TEST(test_json_cursor) {
+  const char *source = "{\"skip\": {\"a\": [1, \"]}\\\"[{\", {\"b\": \"}\"}], \"c\": {}},"
+                       " \"id\": 42, \"tags\": [\"x\", true, null], \"name\": \"cursor\", \"last\": [[1], 2]}";
+  const char *end = source + strlen(source);
+  json_cursor c;
+  json_value v;
+  reference key;
+  int64_t n;
+
+  /* read a few fields, skipping the subtrees in between */
+  json_cursor_init(&c, source, end);
+  ASSERT_TRUE(json_cursor_next(&c, &key, &v));
+  ASSERT_EQ(v.type, J_OBJECT);
+  ASSERT_PTR_NULL(key.ptr);
+  ASSERT_TRUE(json_cursor_find_field(&c, "id", 2, &v));
+  ASSERT_EQ(v.type, J_NUMBER);
+  ASSERT_TRUE(json_get_int64(&v, &n));
+  ASSERT_TRUE(n == 42);
+  ASSERT_TRUE(json_cursor_find_field(&c, "tags", 4, &v));
+  ASSERT_EQ(v.type, J_ARRAY);
+  ASSERT_FALSE(json_cursor_find_field(&c, "x", 1, &v));
+  ASSERT_TRUE(json_cursor_next(&c, &key, &v));
+  ASSERT_EQ(v.type, J_STRING);
+  ASSERT_PTR_NULL(key.ptr);
+  ASSERT_TRUE(json_cursor_next(&c, NULL, &v));
+  ASSERT_EQ(v.type, J_BOOLEAN);
+  ASSERT_TRUE(json_cursor_next(&c, NULL, &v));
+  ASSERT_EQ(v.type, J_NULL);
+  ASSERT_FALSE(json_cursor_next(&c, NULL, &v));
+  ASSERT_FALSE(c.failed);
+  ASSERT_TRUE(json_cursor_next(&c, &key, &v));
+  ASSERT_EQ(key.len, 4);
+  ASSERT_TRUE(strncmp(key.ptr, "name", 4) == 0);
+  ASSERT_EQ(v.u.string.len, 6);
+  ASSERT_TRUE(json_cursor_skip(&c));
+  ASSERT_FALSE(c.failed);
+  ASSERT_EQ(c.depth, 0);
+  ASSERT_FALSE(json_cursor_next(&c, NULL, &v));
+  ASSERT_FALSE(c.failed);
+
+  /* missing field: the object is read to its end */
+  json_cursor_init(&c, source, end);
+  ASSERT_TRUE(json_cursor_next(&c, NULL, &v));
+  ASSERT_FALSE(json_cursor_find_field(&c, "missing", 7, &v));
+  ASSERT_FALSE(c.failed);
+  ASSERT_EQ(c.depth, 0);
+
+  /* walk every element */
+  const char *array = "[1, [2, [3, {\"k\": 4}]], 5]";
+  int64_t sum = 0;
+  json_cursor_init(&c, array, array + strlen(array));
+  while (!c.failed && (c.depth > 0 || !c.started)) {
+    if (json_cursor_next(&c, NULL, &v) && v.type == J_NUMBER) {
+      ASSERT_TRUE(json_get_int64(&v, &n));
+      sum += n;
+    }
+  }
+  ASSERT_FALSE(c.failed);
+  ASSERT_TRUE(sum == 15);
+
+  /* invalid input */
+  const char *invalid[] = {"[1,]", "[1 2]", "{\"a\" 1}", "\"a\"", "[1] ", "[1]]"};
+  size_t i;
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    json_cursor_init(&c, invalid[i], invalid[i] + strlen(invalid[i]));
+    while (json_cursor_next(&c, NULL, &v) || (c.depth > 0 && !c.failed))
+      ;
+    ASSERT_TRUE(c.failed);
+  }
+  const char *unterminated = "{\"a\": [1, \"]\"";
+  json_cursor_init(&c, unterminated, unterminated + strlen(unterminated));
+  ASSERT_TRUE(json_cursor_next(&c, NULL, &v));
+  ASSERT_TRUE(json_cursor_find_field(&c, "a", 1, &v));
+  ASSERT_FALSE(json_cursor_skip(&c));
+  ASSERT_TRUE(c.failed);
+  json_cursor_init(&c, source, source);
+  ASSERT_FALSE(json_cursor_next(&c, NULL, &v));
+  END_TEST;
+}
+
+TEST(test_json_skip_value) {
+  const char *values[] = {"{\"a\": [1, 2, {\"b\": \"]}\\\"\"}], \"c\": {}}",
+                          "[[[[[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]]]], [[[[[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]]]]]]",
+                          "[\"\\\\\", \"\\\\\\\"\", \"{{{{{{{{{{{{{{{{{{{{{{{{{{{{{{\", [], {}]",
+                          "\"plain string that is longer than one block\"",
+                          "-12.5e+3",
+                          "true",
+                          "false",
+                          "null"};
+  char buffer[256];
+  size_t i;
+  for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    size_t len = strlen(values[i]);
+    /* alone, and followed by more input */
+    ASSERT_PTR_EQUAL(json_skip_value(values[i], values[i] + len), values[i] + len);
+    sprintf(buffer, "  %s, 1]", values[i]);
+    ASSERT_PTR_EQUAL(json_skip_value(buffer, buffer + strlen(buffer)), buffer + 2 + len);
+    /* cut short */
+    if (values[i][0] == '{' || values[i][0] == '[' || values[i][0] == '"')
+      ASSERT_PTR_NULL(json_skip_value(values[i], values[i] + len - 1));
+  }
+  const char *invalid[] = {"", "   ", "trux", "nul", "truex", "]", ":"};
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    ASSERT_PTR_NULL(json_skip_value(invalid[i], invalid[i] + strlen(invalid[i])));
+  END_TEST;
+}
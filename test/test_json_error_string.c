@@ -39,4 +39,86 @@ TEST(test_json_error_string_with_validate) {
   ASSERT(strcmp(json_error_string(error), "Invalid JSON") == 0);
 
   END_TEST;
-}
\ No newline at end of file
+}
+
+TEST(test_json_validate_located) {
+  const char *source = "{\n  \"a\": 1,\n  \"b\": tru\n}";
+  const char *valid = "[1, 2]";
+  json_result result;
+  ASSERT_EQUAL(json_validate_located(source, source + strlen(source), &result), E_EXPECTED_CONSTANT, json_error);
+  ASSERT_EQUAL(result.error, E_EXPECTED_CONSTANT, json_error);
+  ASSERT_EQUAL(result.offset, 19, size_t);
+  ASSERT_EQUAL(result.line, 3, size_t);
+  ASSERT_EQUAL(result.column, 8, size_t);
+  source = "{\"a\" 1}";
+  ASSERT_EQUAL(json_validate_located(source, source + strlen(source), &result), E_EXPECTED_OBJECT_VALUE, json_error);
+  ASSERT_EQUAL(result.offset, 5, size_t);
+  ASSERT_EQUAL(result.line, 1, size_t);
+  ASSERT_EQUAL(result.column, 6, size_t);
+  ASSERT_EQUAL(json_validate_located(valid, valid + strlen(valid), &result), E_OK, json_error);
+  ASSERT_EQUAL(result.offset, 0, size_t);
+  ASSERT_EQUAL(result.line, 0, size_t);
+  END_TEST;
+}
+
+TEST(test_json_parse_located) {
+  /* long enough for the vector newline count: 40 lines of 24 bytes, then a bad byte */
+  const char *line = "  1234567890123456789,\n";
+  const char *small = "{\"a\": [true, false]}";
+  size_t lines = 40;
+  size_t len = 0;
+  size_t i;
+  json_value value;
+  json_result result;
+  char *source = (char *)malloc(2 + lines * strlen(line) + 4);
+  ASSERT_PTR_NOT_NULL(source);
+  source[len++] = '[';
+  source[len++] = '\n';
+  for (i = 0; i < lines; i++) {
+    memcpy(source + len, line, strlen(line));
+    len += strlen(line);
+  }
+  memcpy(source + len, "  x]", 4);
+  len += 4;
+  memset(&value, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_located(source, source + len, &value, &result));
+  ASSERT_EQUAL(result.error, E_INVALID_JSON, json_error);
+  ASSERT_EQUAL(result.offset, len - 2, size_t);
+  ASSERT_EQUAL(result.line, lines + 2, size_t);
+  ASSERT_EQUAL(result.column, 3, size_t);
+  json_reset();
+  free(source);
+  memset(&value, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_located(small, small + strlen(small), &value, &result));
+  ASSERT_EQUAL(result.error, E_OK, json_error);
+  json_free(&value);
+  json_reset();
+  END_TEST;
+}
+
+TEST(test_json_parse_located_pool) {
+  /* well-formed, but more elements than the array node pool holds */
+  size_t count = JSON_VALUE_POOL_SIZE + 1;
+  size_t len = 0;
+  size_t i;
+  json_value value;
+  json_result result;
+  char *source = (char *)malloc(count * 2 + 1);
+  ASSERT_PTR_NOT_NULL(source);
+  source[len++] = '[';
+  for (i = 0; i < count; i++) {
+    source[len++] = '0';
+    source[len++] = ',';
+  }
+  source[len - 1] = ']';
+  json_reset();
+  memset(&value, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_located(source, source + len, &value, &result));
+  ASSERT_EQUAL(result.error, E_NO_MEMORY_ARRAY, json_error);
+  ASSERT_EQUAL(result.offset, 0, size_t);
+  ASSERT_EQUAL(result.line, 1, size_t);
+  ASSERT_EQUAL(result.column, 1, size_t);
+  json_reset();
+  free(source);
+  END_TEST;
+}
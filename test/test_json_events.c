@@ -0,0 +1,110 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+typedef struct {
+  char trace[256];
+  size_t len;
+  size_t events;
+  size_t stop_after;
+  int64_t sum;
+} events_state;
+
+static bool events_record(events_state *state, char c) {
+  if (state->len + 1 < sizeof(state->trace)) {
+    state->trace[state->len++] = c;
+    state->trace[state->len] = '\0';
+  }
+  return ++state->events != state->stop_after;
+}
+
+static bool on_object_begin(void *user) { return events_record((events_state *)user, '{'); }
+static bool on_object_end(void *user) { return events_record((events_state *)user, '}'); }
+static bool on_array_begin(void *user) { return events_record((events_state *)user, '['); }
+static bool on_array_end(void *user) { return events_record((events_state *)user, ']'); }
+static bool on_null(void *user) { return events_record((events_state *)user, 'z'); }
+static bool on_boolean(bool value, void *user) { return events_record((events_state *)user, value ? 't' : 'f'); }
+
+static bool on_key(const json_value *key, void *user) {
+  events_state *state = (events_state *)user;
+  return key->type == J_STRING && key->u.string.len == 1 && events_record(state, key->u.string.ptr[0]);
+}
+
+static bool on_string(const json_value *value, void *user) {
+  char decoded[16];
+  if (json_string_decode(value, decoded) != 2 || memcmp(decoded, "\xC3\xA9", 2) != 0)
+    return false;
+  return events_record((events_state *)user, 's');
+}
+
+static bool on_number(const json_value *value, void *user) {
+  events_state *state = (events_state *)user;
+  int64_t n;
+  if (!json_get_int64(value, &n))
+    return false;
+  state->sum += n;
+  return events_record(state, 'n');
+}
+
+static const json_handler recorder = {on_object_begin, on_object_end, on_array_begin, on_array_end, on_key,
+                                      on_string,       on_number,     on_boolean,     on_null};
+
+static bool events_parse(const char *source, events_state *state) {
+  memset(state, 0, sizeof(events_state));
+  return json_parse_events(source, source + strlen(source), &recorder, state);
+}
+
+TEST(test_json_parse_events) {
+  events_state state;
+  const char *source = "{\"a\": \"\\u00e9\", \"b\" : 7, \"c\": [true, false, null, [], {}], \"d\": {\"e\": -2}}";
+  ASSERT_TRUE(events_parse(source, &state));
+  ASSERT_TRUE(strcmp(state.trace, "{asbnc[tfz[]{}]d{en}}") == 0);
+  ASSERT_TRUE(state.sum == 5);
+
+  /* a callback stops the parse */
+  memset(&state, 0, sizeof(events_state));
+  state.stop_after = 3;
+  ASSERT_FALSE(json_parse_events(source, source + strlen(source), &recorder, &state));
+  ASSERT_EQ(state.events, 3);
+
+  /* missing callbacks are skipped */
+  json_handler empty;
+  memset(&empty, 0, sizeof(json_handler));
+  ASSERT_TRUE(json_parse_events(source, source + strlen(source), &empty, NULL));
+
+  /* malformed input */
+  const char *invalid[] = {"[1,]", "[,1]", "{\"a\" 1}", "{\"a\": 1,}", "{1: 2}", "[1 2]", "[1]]", "[[1]", "[1] ", "\"a\"", "[tru]", "{\"a\": }"};
+  size_t i;
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    ASSERT_FALSE(events_parse(invalid[i], &state));
+  ASSERT_FALSE(json_parse_events(source, source, &recorder, &state));
+  ASSERT_FALSE(json_parse_events(source, source + strlen(source), NULL, &state));
+  END_TEST;
+}
+
+TEST(test_json_parse_events_unbounded) {
+  /* more elements than the node pools hold, nested deeper than the initial depth stack */
+  size_t count = JSON_VALUE_POOL_SIZE * 2;
+  size_t depth = 1000;
+  size_t len = 0;
+  size_t i;
+  events_state state;
+  json_handler counter;
+  char *source = (char *)malloc(count * 2 + depth * 2 + 2);
+  ASSERT_PTR_NOT_NULL(source);
+  for (i = 0; i < depth; i++)
+    source[len++] = '[';
+  for (i = 0; i < count; i++) {
+    source[len++] = '1';
+    source[len++] = ',';
+  }
+  source[len - 1] = ']';
+  for (i = 1; i < depth; i++)
+    source[len++] = ']';
+  memset(&counter, 0, sizeof(json_handler));
+  counter.on_number = on_number;
+  memset(&state, 0, sizeof(events_state));
+  ASSERT_TRUE(json_parse_events(source, source + len, &counter, &state));
+  ASSERT_TRUE(state.sum == (int64_t)count);
+  free(source);
+  END_TEST;
+}
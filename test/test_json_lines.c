@@ -0,0 +1,103 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+typedef struct {
+  size_t documents;
+  size_t objects;
+  size_t stop_after;
+  size_t source_bytes;
+} lines_state;
+
+static bool count_document(json_value *doc, reference source, void *user) {
+  lines_state *state = (lines_state *)user;
+  state->documents++;
+  state->source_bytes += source.len;
+  if (doc->type == J_OBJECT)
+    state->objects++;
+  return state->documents != state->stop_after;
+}
+
+TEST(test_json_parse_lines) {
+  const char *source = "{\"id\": 1, \"text\": \"first line\"}\n"
+                       "[1, 2, 3]\r\n"
+                       "\n"
+                       "   {\"id\": 2, \"nested\": {\"a\": [true, null]}}   \n"
+                       "{\"id\": 3, \"long\": \"0123456789abcdef0123456789abcdef\"}";
+  lines_state state;
+  size_t count;
+
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_lines(source, source + strlen(source), count_document, &state, &count));
+  ASSERT_EQ(count, 4);
+  ASSERT_EQ(state.documents, 4);
+  ASSERT_EQ(state.objects, 3);
+  ASSERT_EQ(state.source_bytes, 31 + 9 + 40 + 53);
+
+  /* the callback stops the batch */
+  memset(&state, 0, sizeof(state));
+  state.stop_after = 2;
+  ASSERT_FALSE(json_parse_lines(source, source + strlen(source), count_document, &state, &count));
+  ASSERT_EQ(count, 2);
+
+  /* an invalid record stops the batch, count is its index */
+  const char *invalid = "[1]\n[2]\n{\"broken\": }\n[4]\n";
+  memset(&state, 0, sizeof(state));
+  ASSERT_FALSE(json_parse_lines(invalid, invalid + strlen(invalid), count_document, &state, &count));
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(state.documents, 2);
+
+  /* empty input */
+  ASSERT_TRUE(json_parse_lines(source, source, count_document, &state, &count));
+  ASSERT_EQ(count, 0);
+  END_TEST;
+}
+
+typedef struct {
+  size_t documents;
+  size_t ends[8];
+  const char *input;
+} documents_state;
+
+static bool record_end(json_value *doc, reference source, void *user) {
+  documents_state *state = (documents_state *)user;
+  if (doc->type != J_OBJECT && doc->type != J_ARRAY)
+    return false;
+  if (state->documents < 8)
+    state->ends[state->documents] = (size_t)(source.ptr + source.len - state->input);
+  state->documents++;
+  return true;
+}
+
+TEST(test_json_parse_documents) {
+  /* concatenated documents, with and without whitespace in between */
+  const char *concatenated = "{\"a\": [1, {}]}{\"b\": 2}[3]\n  [\"}{\"]";
+  documents_state state;
+  size_t count;
+  memset(&state, 0, sizeof(state));
+  state.input = concatenated;
+  ASSERT_TRUE(json_parse_documents(concatenated, concatenated + strlen(concatenated), record_end, &state, &count));
+  ASSERT_EQ(count, 4);
+  ASSERT_EQ(state.ends[0], 14);
+  ASSERT_EQ(state.ends[1], 22);
+  ASSERT_EQ(state.ends[2], 25);
+  ASSERT_EQ(state.ends[3], strlen(concatenated));
+
+  /* RFC 7464 text sequence */
+  const char *sequence = "\x1E{\"id\": 1}\n\x1E[2]\n\x1E\n";
+  memset(&state, 0, sizeof(state));
+  state.input = sequence;
+  ASSERT_TRUE(json_parse_documents(sequence, sequence + strlen(sequence), record_end, &state, &count));
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(state.ends[1], 15);
+
+  /* the bad document is reported by its index */
+  const char *invalid = "[1][2]{\"a\" 1}[4]";
+  ASSERT_FALSE(json_parse_documents(invalid, invalid + strlen(invalid), record_end, &state, &count));
+  ASSERT_EQ(count, 2);
+  ASSERT_FALSE(json_parse_documents("[1] 2", "[1] 2" + 5, record_end, &state, &count));
+  ASSERT_EQ(count, 1);
+  ASSERT_FALSE(json_parse_documents("[1][2", "[1][2" + 5, record_end, &state, &count));
+  ASSERT_TRUE(json_parse_documents("  ", "  " + 2, record_end, &state, &count));
+  ASSERT_EQ(count, 0);
+  END_TEST;
+}
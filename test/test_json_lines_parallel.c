@@ -0,0 +1,76 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+#define PARALLEL_RECORDS 5000
+#define PARALLEL_WORKERS 4
+
+typedef struct {
+  size_t documents[PARALLEL_WORKERS];
+  int64_t sum[PARALLEL_WORKERS];
+  const char *first[PARALLEL_WORKERS];
+  const char *last[PARALLEL_WORKERS];
+} parallel_state;
+
+static bool sum_document(json_value *doc, reference source, size_t worker, void *user) {
+  parallel_state *state = (parallel_state *)user;
+  int64_t id = 0;
+  if (worker >= PARALLEL_WORKERS || doc->type != J_ARRAY || !json_get_int64(&doc->u.array.items->item, &id))
+    return false;
+  if (state->documents[worker]++ == 0)
+    state->first[worker] = source.ptr;
+  state->last[worker] = source.ptr;
+  state->sum[worker] += id;
+  return true;
+}
+
+TEST(test_json_parse_lines_parallel) {
+  char *source = (char *)malloc(PARALLEL_RECORDS * 64);
+  parallel_state state;
+  size_t length = 0;
+  size_t documents = 0;
+  size_t count;
+  int64_t sum = 0;
+  int i;
+  ASSERT_PTR_NOT_NULL(source);
+  for (i = 1; i <= PARALLEL_RECORDS; i++)
+    length += (size_t)sprintf(source + length, "[%d, {\"text\": \"record\", \"ok\": true}]\n", i);
+
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_lines_parallel(source, source + length, PARALLEL_WORKERS, sum_document, &state, &count));
+  ASSERT_EQ(count, PARALLEL_RECORDS);
+  for (i = 0; i < PARALLEL_WORKERS; i++) {
+    documents += state.documents[i];
+    sum += state.sum[i];
+    ASSERT_TRUE(state.documents[i] > 0);
+    /* chunks are contiguous and in input order */
+    if (i > 0)
+      ASSERT_TRUE(state.last[i - 1] < state.first[i]);
+  }
+  ASSERT_EQ(documents, PARALLEL_RECORDS);
+  ASSERT_TRUE(sum == (int64_t)PARALLEL_RECORDS * (PARALLEL_RECORDS + 1) / 2);
+
+  /* one thread parses on the caller, more threads than records leave workers idle */
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_lines_parallel(source, source + length, 0, sum_document, &state, &count));
+  ASSERT_EQ(count, PARALLEL_RECORDS);
+  ASSERT_EQ(state.documents[0], PARALLEL_RECORDS);
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_lines_parallel("[1]\n[2]", "[1]\n[2]" + 7, PARALLEL_WORKERS, sum_document, &state, &count));
+  ASSERT_EQ(count, 2);
+
+  /* an invalid record fails its worker only */
+  source[length / 2] = '}';
+  memset(&state, 0, sizeof(state));
+  ASSERT_FALSE(json_parse_lines_parallel(source, source + length, PARALLEL_WORKERS, sum_document, &state, &count));
+  ASSERT_TRUE(count < PARALLEL_RECORDS);
+  ASSERT_TRUE(count > PARALLEL_RECORDS / 2);
+
+  /* the shared pools are untouched by the workers */
+  json_value root;
+  memset(&root, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative("[1, 2]", "[1, 2]" + 6, &root));
+  ASSERT_PTR_NOT_NULL(root.u.array.items);
+  json_reset();
+  free(source);
+  END_TEST;
+}
@@ -0,0 +1,181 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+#define NUMBER_BUFFER_SIZE 0x40
+#define RANDOM_NUMBER_COUNT 0x4000
+
+static json_value number_value(const char *text) {
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  v.type = J_NUMBER;
+  v.u.number.ptr = text;
+  v.u.number.len = strlen(text);
+  return v;
+}
+
+static bool double_matches_strtod(const char *text) {
+  json_value v = number_value(text);
+  double value;
+  if (!json_get_double(&v, &value))
+    return false;
+  double expected = strtod(text, NULL);
+  return memcmp(&value, &expected, sizeof(double)) == 0;
+}
+
+TEST(test_json_get_double) {
+  static const char *numbers[] = {
+      "0", "-0", "1", "-1", "0.1", "0.2", "0.3", "3.14159", "-2.5e-3", "1e22", "1e23", "1E-22", "1e-23",
+      "123456789012345678", "9007199254740992", "9007199254740993", "12345678901234567890123",
+      "0.000001", "2.2250738585072014e-308", "4.9e-324", "1.7976931348623157e308", "1e-400",
+      "7.2057594037927933e16", "0.1e1", "100e-2", "1.00000000000000000000000001"};
+  size_t i;
+  for (i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+    if (!double_matches_strtod(numbers[i])) {
+      printf("mismatch for %s\n", numbers[i]);
+      ASSERT(false);
+    }
+  }
+
+  double value = 1;
+  json_value v = number_value("-0");
+  ASSERT_TRUE(json_get_double(&v, &value));
+  ASSERT_TRUE(value == 0 && 1.0 / value < 0); /* -0.0 */
+
+  v = number_value("1e309");
+  ASSERT_FALSE(json_get_double(&v, &value));
+  v = number_value("-1e400");
+  ASSERT_FALSE(json_get_double(&v, &value));
+
+  json_value s;
+  memset(&s, 0, sizeof(json_value));
+  s.type = J_STRING;
+  ASSERT_FALSE(json_get_double(&s, &value));
+  ASSERT_FALSE(json_get_double(NULL, &value));
+  END_TEST;
+}
+
+TEST(test_json_get_double_random) {
+  char buffer[NUMBER_BUFFER_SIZE];
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  int i;
+  for (i = 0; i < RANDOM_NUMBER_COUNT; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t mantissa = (seed >> 11) % 100000000000000000ULL;
+    int exponent = (int)((seed >> 3) % 80) - 40;
+    sprintf(buffer, "%s%llu.%llue%d", (seed & 1) ? "-" : "", (unsigned long long)(mantissa / 1000), (unsigned long long)(mantissa % 1000), exponent);
+    if (!double_matches_strtod(buffer)) {
+      printf("mismatch for %s\n", buffer);
+      ASSERT(false);
+      break;
+    }
+  }
+  END_TEST;
+}
+
+TEST(test_json_get_int64) {
+  int64_t value;
+  json_value v = number_value("9223372036854775807");
+  ASSERT_TRUE(json_get_int64(&v, &value));
+  ASSERT_TRUE(value == INT64_MAX);
+  v = number_value("-9223372036854775808");
+  ASSERT_TRUE(json_get_int64(&v, &value));
+  ASSERT_TRUE(value == INT64_MIN);
+  v = number_value("-42");
+  ASSERT_TRUE(json_get_int64(&v, &value));
+  ASSERT_TRUE(value == -42);
+  v = number_value("9223372036854775808");
+  ASSERT_FALSE(json_get_int64(&v, &value));
+  v = number_value("-9223372036854775809");
+  ASSERT_FALSE(json_get_int64(&v, &value));
+  v = number_value("1.0");
+  ASSERT_FALSE(json_get_int64(&v, &value));
+  v = number_value("1e3");
+  ASSERT_FALSE(json_get_int64(&v, &value));
+
+  uint64_t unsigned_value;
+  v = number_value("18446744073709551615");
+  ASSERT_TRUE(json_get_uint64(&v, &unsigned_value));
+  ASSERT_TRUE(unsigned_value == UINT64_MAX);
+  v = number_value("18446744073709551616");
+  ASSERT_FALSE(json_get_uint64(&v, &unsigned_value));
+  v = number_value("-1");
+  ASSERT_FALSE(json_get_uint64(&v, &unsigned_value));
+  v = number_value("-0");
+  ASSERT_TRUE(json_get_uint64(&v, &unsigned_value));
+  ASSERT_TRUE(unsigned_value == 0);
+  END_TEST;
+}
+
+TEST(test_json_get_doubles) {
+  const char *source = "[1, -2.5, 3e2, 4, \"five\", 6]";
+  json_value v;
+  double values[8];
+  int64_t integers[8];
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &v));
+  ASSERT_EQ(json_get_doubles(&v, values, 8), 4);
+  ASSERT_TRUE(values[0] == 1.0 && values[1] == -2.5 && values[2] == 300.0 && values[3] == 4.0);
+  ASSERT_EQ(json_get_doubles(&v, values, 2), 2);
+  ASSERT_EQ(json_get_int64s(&v, integers, 8), 1);
+  ASSERT_TRUE(integers[0] == 1);
+  ASSERT_EQ(json_get_doubles(&v.u.array.items->item, values, 8), 0);
+  json_reset();
+  END_TEST;
+}
+
+TEST(test_json_number_decoding) {
+#ifdef NUMBER_DECODING
+  double value;
+  const char *source = "[0, -0, 12345678, 1234567890123456789, -9223372036854775808, 9223372036854775808, 0.5, -1.25e2, 1e400, 123456789.0123456789, 151.20929550000001]";
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &v));
+  json_array_node *node = v.u.array.items;
+  const json_number *n = &node->item.u.number;
+  ASSERT_TRUE((node->item.flags & (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER)) == (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER));
+  ASSERT_TRUE(n->value.integer == 0);
+  node = node->next;
+  n = &node->item.u.number;
+  ASSERT_TRUE((node->item.flags & JSON_NUMBER_NEGATIVE) != 0 && n->value.integer == 0);
+  node = node->next;
+  ASSERT_TRUE(node->item.u.number.value.integer == 12345678);
+  node = node->next;
+  ASSERT_TRUE(node->item.u.number.value.integer == 1234567890123456789LL);
+  node = node->next;
+  ASSERT_TRUE(node->item.u.number.value.integer == INT64_MIN);
+  node = node->next;
+  ASSERT_TRUE((node->item.flags & (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER | JSON_NUMBER_OVERFLOW)) == (JSON_NUMBER_INTEGER | JSON_NUMBER_OVERFLOW));
+  ASSERT_TRUE(json_get_double(&node->item, &value) && value == 9223372036854775808.0);
+  uint64_t unsigned_value;
+  ASSERT_TRUE(json_get_uint64(&node->item, &unsigned_value));
+  ASSERT_TRUE(unsigned_value == 9223372036854775808ULL);
+  node = node->next;
+  ASSERT_TRUE(!(node->item.flags & JSON_NUMBER_INTEGER) && json_get_double(&node->item, &value) && value == 0.5);
+  node = node->next;
+  ASSERT_TRUE((node->item.flags & JSON_NUMBER_EXPONENT) != 0 && json_get_double(&node->item, &value) && value == -125.0);
+  /* numbers off the fast path are classified, and converted only by the accessors */
+  node = node->next;
+  ASSERT_TRUE((node->item.flags & (JSON_NUMBER_DECODED | JSON_NUMBER_EXPONENT)) == JSON_NUMBER_EXPONENT);
+  ASSERT_FALSE(json_get_double(&node->item, &value));
+  node = node->next;
+  ASSERT_TRUE((node->item.flags & (JSON_NUMBER_DECODED | JSON_NUMBER_INTEGER)) == 0);
+  ASSERT_TRUE(json_get_double(&node->item, &value));
+  ASSERT_TRUE(value == strtod("123456789.0123456789", NULL));
+  node = node->next;
+  ASSERT_TRUE((node->item.flags & JSON_NUMBER_DECODED) == 0);
+  ASSERT_TRUE(json_get_double(&node->item, &value));
+  ASSERT_TRUE(value == strtod("151.20929550000001", NULL));
+  json_reset();
+#else
+  /* without the flag the parser leaves the value undecoded and the flags clear */
+  const char *source = "[42]";
+  json_value v;
+  int64_t integer;
+  memset(&v, 0xFF, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &v));
+  ASSERT_TRUE(v.u.array.items->item.flags == 0);
+  ASSERT_TRUE(json_get_int64(&v.u.array.items->item, &integer) && integer == 42);
+  json_reset();
+#endif
+  END_TEST;
+}
@@ -0,0 +1,48 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+TEST(test_json_parse_file) {
+  const char *files[] = {"data/test.json", "data/array.json", "data/object.json"};
+  json_value mapped;
+  json_value copied;
+  json_file *file;
+  size_t i;
+  for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    char *source = utils_get_test_json_data(files[i]);
+    ASSERT_PTR_NOT_NULL(source);
+    memset(&mapped, 0, sizeof(json_value));
+    memset(&copied, 0, sizeof(json_value));
+    ASSERT_TRUE(json_parse_file(files[i], &mapped, &file));
+    ASSERT_PTR_NOT_NULL(file);
+    ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &copied));
+    ASSERT_TRUE(json_equal(&mapped, &copied));
+    json_file_close(file);
+    json_reset();
+    free(source);
+  }
+
+  /* trailing whitespace is ignored, anything else after the root is not */
+  const char *filename = "parse_file.json";
+  FILE *fp = fopen(filename, "w");
+  ASSERT_PTR_NOT_NULL(fp);
+  fprintf(fp, "{\"key\": [1, \"value\"]}  \r\n\n");
+  fclose(fp);
+  ASSERT_TRUE(json_parse_file(filename, &mapped, &file));
+  ASSERT_EQ(mapped.type, J_OBJECT);
+  ASSERT_EQ(mapped.u.object.items->item.value.u.array.last->item.u.string.len, 5);
+  json_file_close(file);
+  json_reset();
+  fp = fopen(filename, "w");
+  fprintf(fp, "{\"key\": 1} x\n");
+  fclose(fp);
+  ASSERT_FALSE(json_parse_file(filename, &mapped, &file));
+  ASSERT_PTR_NULL(file);
+  fp = fopen(filename, "w");
+  fclose(fp);
+  ASSERT_FALSE(json_parse_file(filename, &mapped, &file));
+  remove(filename);
+  ASSERT_FALSE(json_parse_file(filename, &mapped, &file));
+  ASSERT_FALSE(json_parse_file(files[0], &mapped, NULL));
+  json_file_close(NULL);
+  END_TEST;
+}
@@ -0,0 +1,81 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+#define BATCH_FILES 24
+#define BATCH_WORKERS 3
+
+typedef struct {
+  int64_t ids[BATCH_FILES];
+  bool failed[BATCH_FILES];
+  size_t calls[BATCH_WORKERS];
+} batch_state;
+
+static bool collect_file(json_value *doc, reference source, size_t index, size_t worker, void *user) {
+  batch_state *state = (batch_state *)user;
+  if (index >= BATCH_FILES || worker >= BATCH_WORKERS || index % BATCH_WORKERS != worker)
+    return false;
+  state->calls[worker]++;
+  if (doc == NULL) {
+    state->failed[index] = true;
+    return true;
+  }
+  if (source.len == 0 || source.ptr[source.len - 1] != '}')
+    return false;
+  return json_get_int64(&doc->u.object.items->item.value, &state->ids[index]);
+}
+
+static bool count_file(json_value *doc, reference source, size_t index, size_t worker, void *user) {
+  (void)source;
+  (void)index;
+  if (doc == NULL || worker != 0)
+    return false;
+  (*(size_t *)user)++;
+  return true;
+}
+
+TEST(test_json_parse_files) {
+  char names[BATCH_FILES][32];
+  const char *paths[BATCH_FILES];
+  batch_state state;
+  size_t i;
+  for (i = 0; i < BATCH_FILES; i++) {
+    FILE *fp;
+    sprintf(names[i], "batch_%u.json", (unsigned)i);
+    paths[i] = names[i];
+    fp = fopen(names[i], "w");
+    ASSERT_PTR_NOT_NULL(fp);
+    fprintf(fp, "{\"id\": %u, \"padding\": \"%*s\"}\n\n", (unsigned)(i * 10), (int)(i * 100), "");
+    fclose(fp);
+  }
+
+  memset(&state, 0, sizeof(state));
+  ASSERT_TRUE(json_parse_files(paths, BATCH_FILES, BATCH_WORKERS, collect_file, &state));
+  for (i = 0; i < BATCH_FILES; i++) {
+    ASSERT_FALSE(state.failed[i]);
+    ASSERT_TRUE(state.ids[i] == (int64_t)(i * 10));
+  }
+  for (i = 0; i < BATCH_WORKERS; i++)
+    ASSERT_EQ(state.calls[i], BATCH_FILES / BATCH_WORKERS);
+
+  /* a broken and a missing file are reported and do not stop the batch */
+  FILE *fp = fopen(names[4], "w");
+  fprintf(fp, "{\"id\": }");
+  fclose(fp);
+  remove(names[7]);
+  memset(&state, 0, sizeof(state));
+  ASSERT_FALSE(json_parse_files(paths, BATCH_FILES, BATCH_WORKERS, collect_file, &state));
+  ASSERT_TRUE(state.failed[4]);
+  ASSERT_TRUE(state.failed[7]);
+  ASSERT_FALSE(state.failed[5]);
+  ASSERT_TRUE(state.ids[23] == 230);
+
+  /* one thread, and no files */
+  size_t parsed = 0;
+  ASSERT_TRUE(json_parse_files(paths, 4, 0, count_file, &parsed));
+  ASSERT_EQ(parsed, 4);
+  ASSERT_TRUE(json_parse_files(paths, 0, 4, count_file, &parsed));
+  ASSERT_FALSE(json_parse_files(NULL, 0, 4, collect_file, &state));
+  for (i = 0; i < BATCH_FILES; i++)
+    remove(names[i]);
+  END_TEST;
+}
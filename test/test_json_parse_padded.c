@@ -0,0 +1,48 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+static bool parse_padded(const char *source, json_value *v) {
+  size_t len = strlen(source);
+  char *buffer = json_padded_buffer(source, len);
+  bool result;
+  if (!buffer)
+    return false;
+  memset(v, 0, sizeof(json_value));
+  result = json_parse_padded(buffer, buffer + len, v);
+  free(buffer);
+  return result;
+}
+
+TEST(test_json_parse_padded) {
+  static const char *valid[] = {"[1]", "[\"0123456789abcdef0123456789\"]", "{\"a\": [true, false, null, -1.5e3]}", "[ 12345678901234567890 ]", "[\"x\\u0041\"]"};
+  static const char *invalid[] = {"[1", "[\"abc", "[\"abc]", "[tru", "[1,", "{\"a\"", "{\"a\":", "[-", "[1.", "[1e", "[] "};
+  json_value v;
+  size_t i;
+  for (i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    ASSERT_TRUE(parse_padded(valid[i], &v));
+    json_reset();
+  }
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    ASSERT_FALSE(parse_padded(invalid[i], &v));
+    json_reset();
+  }
+
+  /* the same tree as the unpadded parser */
+  const char *source = "{\"key\": [1, \"two\", {\"three\": 3}]}";
+  json_value expected;
+  memset(&expected, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &expected));
+  char *buffer = json_padded_buffer(source, strlen(source));
+  ASSERT_PTR_NOT_NULL(buffer);
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_padded(buffer, buffer + strlen(source), &v));
+  ASSERT_TRUE(json_equal(&v, &expected));
+  json_reset();
+
+  /* padding that is not zeroed is rejected */
+  buffer[strlen(source) + JSON_PADDING - 1] = ' ';
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_padded(buffer, buffer + strlen(source), &v));
+  free(buffer);
+  END_TEST;
+}
@@ -0,0 +1,72 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+static char *parallel_document(size_t count, bool object, size_t *len) {
+  char *source = (char *)malloc(count * 64 + 2);
+  size_t i;
+  *len = 0;
+  if (!source)
+    return NULL;
+  source[(*len)++] = object ? '{' : '[';
+  for (i = 0; i < count; i++) {
+    if (i > 0)
+      *len += (size_t)sprintf(source + *len, ", ");
+    if (object)
+      *len += (size_t)sprintf(source + *len, "\"k%u\": ", (unsigned)i);
+    *len += (size_t)sprintf(source + *len, "{\"id\": %u, \"v\": [%u, \"s]\"]}", (unsigned)i, (unsigned)i);
+  }
+  source[(*len)++] = object ? '}' : ']';
+  return source;
+}
+
+TEST(test_json_parse_parallel) {
+  json_value expected;
+  json_value root;
+  json_arena *arena;
+  size_t len;
+  size_t threads;
+  int object;
+  for (object = 0; object < 2; object++) {
+    char *source = parallel_document(8000, object != 0, &len);
+    ASSERT_PTR_NOT_NULL(source);
+    memset(&expected, 0, sizeof(json_value));
+    ASSERT_TRUE(json_parse_iterative(source, source + len, &expected));
+    for (threads = 0; threads <= 5; threads++) {
+      memset(&root, 0, sizeof(json_value));
+      ASSERT_TRUE(json_parse_parallel(source, source + len, threads, &root, &arena));
+      ASSERT_PTR_NOT_NULL(arena);
+      ASSERT_TRUE(json_equal(&root, &expected));
+      json_arena_free(arena);
+    }
+    /* invalid input anywhere fails the whole parse */
+    source[len / 2 + 1] = ':';
+    ASSERT_FALSE(json_parse_parallel(source, source + len, 4, &root, &arena));
+    ASSERT_PTR_NULL(arena);
+    ASSERT_FALSE(json_parse_parallel(source, source + len / 2, 4, &root, &arena));
+    json_reset();
+    free(source);
+  }
+
+  /* more nodes than the shared pools hold */
+  char *large = parallel_document(30000, false, &len);
+  ASSERT_PTR_NOT_NULL(large);
+  memset(&root, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(large, large + len, &root));
+  json_reset();
+  ASSERT_TRUE(json_parse_parallel(large, large + len, 4, &root, &arena));
+  ASSERT_EQ(root.u.array.last->item.u.object.items->item.value.u.number.len, 5);
+  json_arena_free(arena);
+  free(large);
+
+  /* small and empty roots */
+  ASSERT_TRUE(json_parse_parallel("[1]", "[1]" + 3, 8, &root, &arena));
+  ASSERT_EQ(root.u.array.items->item.type, J_NUMBER);
+  json_arena_free(arena);
+  ASSERT_TRUE(json_parse_parallel("{}", "{}" + 2, 8, &root, &arena));
+  ASSERT_PTR_NULL(root.u.object.items);
+  json_arena_free(arena);
+  ASSERT_FALSE(json_parse_parallel("[1] ", "[1] " + 4, 2, &root, &arena));
+  ASSERT_FALSE(json_parse_parallel("[1]", "[1]" + 3, 2, &root, NULL));
+  json_arena_free(NULL);
+  END_TEST;
+}
@@ -0,0 +1,85 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+TEST(test_json_parse_pointer) {
+  const char *source = "{\"meta\": {\"skip\": [1, {\"x\": \"]\"}]}, \"data\": {\"items\": [{\"id\": 0}, [], {\"id\": 2}, {\"id\": 3, \"tags\": [\"a\", \"b\"]}]},"
+                       " \"a/b\": 1, \"m~n\": 2, \"\": 3}";
+  const char *end = source + strlen(source);
+  json_value v;
+  int64_t n;
+
+  ASSERT_TRUE(json_parse_pointer(source, end, "/data/items/3/id", &v));
+  ASSERT_EQ(v.type, J_NUMBER);
+  ASSERT_TRUE(json_get_int64(&v, &n));
+  ASSERT_TRUE(n == 3);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/data/items/3/tags/1", &v));
+  ASSERT_EQ(v.type, J_STRING);
+  ASSERT_TRUE(strncmp(v.u.string.ptr, "b", v.u.string.len) == 0);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/a~1b", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 1);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/m~0n", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 2);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 3);
+
+  /* container targets are built as trees */
+  ASSERT_TRUE(json_parse_pointer(source, end, "/data/items/3", &v));
+  ASSERT_EQ(v.type, J_OBJECT);
+  ASSERT_PTR_NOT_NULL(v.u.object.items);
+  ASSERT_EQ(v.u.object.items->item.key.len, 2);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/data/items/1", &v));
+  ASSERT_EQ(v.type, J_ARRAY);
+  ASSERT_PTR_NULL(v.u.array.items);
+  ASSERT_TRUE(json_parse_pointer(source, end, "", &v));
+  ASSERT_EQ(v.type, J_OBJECT);
+  json_reset();
+
+  /* the input after the target is not read */
+  const char *truncated = "{\"first\": [1, 2], \"rest\": [";
+  ASSERT_TRUE(json_parse_pointer(truncated, truncated + strlen(truncated), "/first/1", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 2);
+
+  const char *missing[] = {"/data/items/4", "/data/items/01", "/data/items/-", "/data/items/x", "/data/missing",
+                           "/data/items/3/id/0", "/m~2n", "data", "/data/items/3/tags/99999999999999999999999"};
+  size_t i;
+  for (i = 0; i < sizeof(missing) / sizeof(missing[0]); i++)
+    ASSERT_FALSE(json_parse_pointer(source, end, missing[i], &v));
+  ASSERT_FALSE(json_parse_pointer(truncated, truncated + strlen(truncated), "/rest", &v));
+  ASSERT_FALSE(json_parse_pointer(source, end, NULL, &v));
+  END_TEST;
+}
+
+TEST(test_json_parse_pointer_escaped_keys) {
+  const char *source = "{\"a\\u0062\": 1, \"x\\/y\": 2, \"\\u007e0\": 3, \"\\ud83d\\ude00\": 4, \"a\\\\b\": 5}";
+  const char *end = source + strlen(source);
+  json_value v;
+  int64_t n;
+
+  ASSERT_TRUE(json_parse_pointer(source, end, "/ab", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 1);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/x~1y", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 2);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/~00", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 3);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/\xF0\x9F\x98\x80", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 4);
+  ASSERT_TRUE(json_parse_pointer(source, end, "/a\\b", &v));
+  ASSERT_TRUE(json_get_int64(&v, &n) && n == 5);
+  ASSERT_FALSE(json_parse_pointer(source, end, "/a\\u0062", &v));
+  ASSERT_FALSE(json_parse_pointer(source, end, "/a", &v));
+  ASSERT_FALSE(json_parse_pointer(source, end, "/abc", &v));
+  END_TEST;
+}
+
+TEST(test_json_parse_pointer_whole_document_trailing) {
+  const char *source = "[1] x";
+  json_value v;
+
+  ASSERT_FALSE(json_parse_pointer(source, source + strlen(source), "", &v));
+  /* a target inside the document still stops at its own end */
+  ASSERT_TRUE(json_parse_pointer(source, source + strlen(source), "/0", &v));
+  ASSERT_TRUE(json_parse_pointer(source, source + 3, "", &v));
+  ASSERT_EQ(v.type, J_ARRAY);
+  json_reset();
+  END_TEST;
+}
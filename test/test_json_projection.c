@@ -0,0 +1,116 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+static const char *projection_source =
+    "{\"statuses\": [{\"text\": \"first\", \"user\": {\"id\": 1, \"name\": \"a\", \"bio\": \"[{\\\"}\"},"
+    " \"entities\": {\"hashtags\": [{\"text\": \"x\", \"indices\": [0, 2]}, {\"text\": \"y\"}], \"urls\": []}},"
+    " {\"text\": \"second\", \"user\": {\"id\": 2, \"name\": \"b\", \"friends\": [[1, 2], {\"c\": 3}]}}],"
+    " \"search_metadata\": {\"count\": 2}}";
+
+static size_t projection_count(const json_value *container) {
+  size_t count = 0;
+  if (container->type == J_OBJECT) {
+    const json_object_node *node;
+    for (node = container->u.object.items; node; node = node->next)
+      count++;
+  } else if (container->type == J_ARRAY) {
+    const json_array_node *node;
+    for (node = container->u.array.items; node; node = node->next)
+      count++;
+  }
+  return count;
+}
+
+TEST(test_json_parse_projected) {
+  const char *paths[] = {"statuses[*].user.id", "statuses[*].user.name", "statuses[*].entities.hashtags[*].text", "search_metadata"};
+  const char *end = projection_source + strlen(projection_source);
+  json_projection *projection = json_projection_compile(paths, sizeof(paths) / sizeof(paths[0]));
+  json_value root;
+  json_value *status;
+  json_value *user;
+  ASSERT_PTR_NOT_NULL(projection);
+  memset(&root, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_projected(projection_source, end, projection, &root));
+  ASSERT_EQ(root.type, J_OBJECT);
+  ASSERT_EQ(projection_count(&root), 2);
+  ASSERT_EQ(root.u.object.items->item.value.type, J_ARRAY);
+  ASSERT_EQ(projection_count(&root.u.object.items->item.value), 2);
+
+  /* only the selected fields and their ancestors */
+  status = &root.u.object.items->item.value.u.array.items->item;
+  ASSERT_EQ(projection_count(status), 2);
+  user = &status->u.object.items->item.value;
+  ASSERT_TRUE(strncmp(status->u.object.items->item.key.ptr, "user", 4) == 0);
+  ASSERT_EQ(projection_count(user), 2);
+  ASSERT_EQ(user->u.object.items->item.value.type, J_NUMBER);
+  json_value *hashtags = &status->u.object.last->item.value.u.object.items->item.value;
+  ASSERT_EQ(projection_count(hashtags), 2);
+  ASSERT_EQ(projection_count(&hashtags->u.array.items->item), 1);
+  ASSERT_EQ(hashtags->u.array.last->item.u.object.items->item.value.type, J_STRING);
+
+  /* a selected container is kept whole */
+  json_value *metadata = &root.u.object.last->item.value;
+  ASSERT_EQ(metadata->type, J_OBJECT);
+  ASSERT_EQ(projection_count(metadata), 1);
+
+  /* the second status has no entities */
+  status = &root.u.object.items->item.value.u.array.last->item;
+  ASSERT_EQ(projection_count(status), 1);
+  json_reset();
+  json_projection_free(projection);
+
+  /* single elements and the whole document */
+  const char *indexed[] = {"statuses[1].user.friends"};
+  projection = json_projection_compile(indexed, 1);
+  ASSERT_PTR_NOT_NULL(projection);
+  ASSERT_TRUE(json_parse_projected(projection_source, end, projection, &root));
+  ASSERT_EQ(projection_count(&root.u.object.items->item.value), 1);
+  ASSERT_EQ(projection_count(&root.u.object.items->item.value.u.array.items->item.u.object.items->item.value.u.object.items->item.value), 2);
+  ASSERT_FALSE(json_parse_projected(projection_source, end - 1, projection, &root));
+  json_reset();
+  json_projection_free(projection);
+  const char *everything[] = {""};
+  projection = json_projection_compile(everything, 1);
+  ASSERT_PTR_NOT_NULL(projection);
+  ASSERT_TRUE(json_parse_projected(projection_source, end, projection, &root));
+  ASSERT_EQ(projection_count(&root), 2);
+  json_reset();
+  json_projection_free(projection);
+
+  const char *malformed[][1] = {{"a..b"}, {"a."}, {"a[x]"}, {"a[1"}, {"a[*]b"}, {".a"}};
+  size_t i;
+  for (i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    ASSERT_PTR_NULL(json_projection_compile(malformed[i], 1));
+  json_projection_free(NULL);
+  END_TEST;
+}
+
+static bool projects_to(const char *source, const char *const *paths, size_t count, const char *expected) {
+  json_projection *projection = json_projection_compile(paths, count);
+  json_value v;
+  json_value want;
+  bool result;
+  if (!projection)
+    return false;
+  memset(&v, 0, sizeof(json_value));
+  memset(&want, 0, sizeof(json_value));
+  result = json_parse_projected(source, source + strlen(source), projection, &v) &&
+           json_parse_iterative(expected, expected + strlen(expected), &want) && json_equal(&v, &want);
+  json_reset();
+  json_projection_free(projection);
+  return result;
+}
+
+TEST(test_json_projection_overlap) {
+  /* an element matched by both [*] and [n] follows both paths, in either order */
+  const char *source = "{\"a\":[{\"x\":1,\"y\":2},{\"x\":3,\"y\":4}],\"m\":[[1,2,3],[4,5,6]]}";
+  const char *any_first[] = {"a[*].x", "a[0].y"};
+  const char *index_first[] = {"a[0].y", "a[*].x"};
+  const char *whole[] = {"a[0].y", "a[*]"};
+  const char *nested[] = {"m[*][2]", "m[1][0]", "m[0][*]"};
+  ASSERT_TRUE(projects_to(source, any_first, 2, "{\"a\":[{\"x\":1,\"y\":2},{\"x\":3}]}"));
+  ASSERT_TRUE(projects_to(source, index_first, 2, "{\"a\":[{\"x\":1,\"y\":2},{\"x\":3}]}"));
+  ASSERT_TRUE(projects_to(source, whole, 2, "{\"a\":[{\"x\":1,\"y\":2},{\"x\":3,\"y\":4}]}"));
+  ASSERT_TRUE(projects_to(source, nested, 3, "{\"m\":[[1,2,3],[4,6]]}"));
+  END_TEST;
+}
@@ -0,0 +1,202 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+static const char *stream_source =
+    "{\"name\": \"stream \\\"quoted\\\" \\u00e9\\ud83d\\ude00 0123456789abcdef0123456789\",\n"
+    " \"numbers\": [0, -12, 3.25, 6.02e23, -1E-7, 12345678901234567890],\n"
+    " \"flags\": [true, false, null, []],\n"
+    " \"nested\": {\"empty\": {}, \"list\": [[1, [2]], {\"k\": \"v\"}]}}  \n";
+
+static bool stream_matches(const char *source, size_t chunk_size) {
+  size_t len = strlen(source);
+  size_t offset = 0;
+  json_value expected;
+  json_value v;
+  json_stream stream;
+  json_stream_status status = JSON_STREAM_MORE;
+  char chunk[0x40];
+  bool result;
+  memset(&expected, 0, sizeof(json_value));
+  memset(&v, 0, sizeof(json_value));
+  /* json_parse_iterative() does not accept trailing whitespace */
+  if (!json_parse_iterative(source, source + len - 3, &expected))
+    return false;
+  json_stream_init(&stream, &v);
+  while (offset < len && status == JSON_STREAM_MORE) {
+    size_t n = len - offset < chunk_size ? len - offset : chunk_size;
+    /* a scratch copy checks that the tree does not reference the chunk */
+    memcpy(chunk, source + offset, n);
+    status = json_stream_feed(&stream, chunk, n);
+    memset(chunk, '#', sizeof(chunk));
+    offset += n;
+  }
+  while (status == JSON_STREAM_DONE && offset < len) {
+    status = json_stream_feed(&stream, source + offset, 1);
+    offset++;
+  }
+  result = status == JSON_STREAM_DONE && json_equal(&v, &expected);
+  json_stream_free(&stream);
+  json_reset();
+  return result;
+}
+
+static json_stream_status stream_bytes(const char *source) {
+  json_value v;
+  json_stream stream;
+  json_stream_status status = JSON_STREAM_MORE;
+  size_t i;
+  memset(&v, 0, sizeof(json_value));
+  json_stream_init(&stream, &v);
+  for (i = 0; source[i] && status != JSON_STREAM_ERROR; i++)
+    status = json_stream_feed(&stream, source + i, 1);
+  json_stream_free(&stream);
+  json_reset();
+  return status;
+}
+
+TEST(test_json_stream_feed) {
+  size_t chunk_size;
+  for (chunk_size = 1; chunk_size <= 0x40; chunk_size++) {
+    if (!stream_matches(stream_source, chunk_size)) {
+      printf("stream mismatch for chunk size %zu\n", chunk_size);
+      ASSERT(false);
+      break;
+    }
+  }
+  ASSERT_EQ(stream_bytes("[1, 2"), JSON_STREAM_MORE);
+  ASSERT_EQ(stream_bytes("[\"abc"), JSON_STREAM_MORE);
+  ASSERT_EQ(stream_bytes("{\"a\": tr"), JSON_STREAM_MORE);
+  ASSERT_EQ(stream_bytes("[1] "), JSON_STREAM_DONE);
+  ASSERT_EQ(stream_bytes("[1] 2"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("[1,]"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("{\"a\" 1}"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("[trux]"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("[1.x]"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("[\"\\x\"]"), JSON_STREAM_ERROR);
+  ASSERT_EQ(stream_bytes("\"top\""), JSON_STREAM_ERROR);
+  END_TEST;
+}
+
+TEST(test_json_parse_iov) {
+  size_t len = strlen(stream_source);
+  char *buffer = (char *)malloc(len);
+  json_iovec iov[0x200];
+  json_value expected;
+  json_value v;
+  json_stream stream;
+  size_t segment;
+  ASSERT_PTR_NOT_NULL(buffer);
+  memcpy(buffer, stream_source, len);
+  memset(&expected, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(stream_source, stream_source + len - 3, &expected));
+  for (segment = 1; segment <= len; segment++) {
+    size_t offset;
+    int count = 0;
+    for (offset = 0; offset < len; offset += segment) {
+      iov[count].base = buffer + offset;
+      iov[count].len = len - offset < segment ? len - offset : segment;
+      count++;
+    }
+    memset(&v, 0, sizeof(json_value));
+    ASSERT_TRUE(json_parse_iov(iov, count, &v, &stream));
+    ASSERT_TRUE(json_equal(&v, &expected));
+    /* the first key spans offsets 1 to 6 with its quotes; unless split it points into the segments */
+    const char *key = v.u.object.items->item.key.ptr;
+    if (1 / segment == 6 / segment)
+      ASSERT_PTR_EQUAL(key, buffer + 2);
+    else
+      ASSERT_TRUE(key < buffer || key >= buffer + len);
+    json_stream_free(&stream);
+  }
+
+  /* incomplete, trailing data, bad arguments */
+  iov[0].base = buffer;
+  iov[0].len = len / 2;
+  ASSERT_FALSE(json_parse_iov(iov, 1, &v, &stream));
+  json_stream_free(&stream);
+  iov[0].len = len;
+  iov[1].base = "x";
+  iov[1].len = 1;
+  ASSERT_FALSE(json_parse_iov(iov, 2, &v, &stream));
+  json_stream_free(&stream);
+  ASSERT_FALSE(json_parse_iov(NULL, 1, &v, &stream));
+  json_stream_free(&stream);
+  ASSERT_FALSE(json_parse_iov(iov, 1, &v, NULL));
+  json_reset();
+  free(buffer);
+  END_TEST;
+}
+
+TEST(test_json_stream_long_token) {
+  /* a token split over thousands of chunks is scanned once, not once per chunk */
+  size_t content = 0x400000;
+  size_t digits = 0x10000;
+  size_t len = content + 4;
+  size_t escapes = 0;
+  size_t chunk = 0x400;
+  size_t offset;
+  size_t i;
+  json_value v;
+  json_stream stream;
+  json_stream_status status = JSON_STREAM_MORE;
+  json_iovec *iov;
+  char *decoded;
+  clock_t start = clock();
+  char *source = (char *)malloc(len);
+  ASSERT_PTR_NOT_NULL(source);
+  source[0] = '[';
+  source[1] = '"';
+  memset(source + 2, 'a', content);
+  /* escapes that straddle chunk boundaries: \" and \\ split after the backslash */
+  for (offset = chunk; offset + 1 < content; offset += chunk) {
+    source[offset - 1] = '\\';
+    source[offset] = (offset / chunk) % 2 ? '"' : '\\';
+    escapes++;
+  }
+  source[len - 2] = '"';
+  source[len - 1] = ']';
+  memset(&v, 0, sizeof(json_value));
+  json_stream_init(&stream, &v);
+  for (offset = 0; offset < len && status == JSON_STREAM_MORE; offset += chunk)
+    status = json_stream_feed(&stream, source + offset, len - offset < chunk ? len - offset : chunk);
+  ASSERT_EQ(status, JSON_STREAM_DONE);
+  decoded = (char *)malloc(content);
+  ASSERT_PTR_NOT_NULL(decoded);
+  ASSERT_TRUE(json_string_decode(&v.u.array.items->item, decoded) == content - escapes);
+  ASSERT_TRUE(decoded[chunk - 3] == '"');
+  free(decoded);
+  json_stream_free(&stream);
+  json_reset();
+
+  /* the same document as MTU-sized segments */
+  iov = (json_iovec *)malloc((len / 1500 + 1) * sizeof(json_iovec));
+  ASSERT_PTR_NOT_NULL(iov);
+  for (i = 0, offset = 0; offset < len; offset += 1500, i++) {
+    iov[i].base = source + offset;
+    iov[i].len = len - offset < 1500 ? len - offset : 1500;
+  }
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iov(iov, (int)i, &v, &stream));
+  ASSERT_TRUE(v.u.array.items->item.u.string.len == content);
+  json_stream_free(&stream);
+  json_reset();
+  free(iov);
+
+  /* a long number fed one byte at a time */
+  source[0] = '[';
+  memset(source + 1, '7', digits);
+  source[digits + 1] = ']';
+  memset(&v, 0, sizeof(json_value));
+  json_stream_init(&stream, &v);
+  status = JSON_STREAM_MORE;
+  for (offset = 0; offset < digits + 2 && status == JSON_STREAM_MORE; offset++)
+    status = json_stream_feed(&stream, source + offset, 1);
+  ASSERT_EQ(status, JSON_STREAM_DONE);
+  ASSERT_TRUE(v.u.array.items->item.u.number.len == digits);
+  json_stream_free(&stream);
+  json_reset();
+  free(source);
+  /* a rescan per chunk takes minutes here */
+  ASSERT_TRUE(clock() - start < 10 * CLOCKS_PER_SEC);
+  END_TEST;
+}
@@ -0,0 +1,127 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+#define DECODE_BUFFER_SIZE 0x100
+
+static bool decodes_to(const char *source, const char *expected, size_t expected_len) {
+  json_value v;
+  char buffer[DECODE_BUFFER_SIZE];
+  size_t len;
+  bool result;
+  memset(&v, 0, sizeof(json_value));
+  if (!json_parse(source, source + strlen(source), &v)) {
+    json_reset();
+    return false;
+  }
+  len = json_string_decode(&v.u.array.items->item, buffer);
+  result = len == expected_len && memcmp(buffer, expected, len) == 0;
+  json_reset();
+  return result;
+}
+
+TEST(test_json_string_decode) {
+  const char *plain = "[\"plain text without escapes, long enough for a chunk\"]";
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(plain, plain + strlen(plain), &v));
+  ASSERT_EQ(v.u.array.items->item.flags & JSON_STRING_HAS_ESCAPES, 0);
+  json_reset();
+  const char *escaped = "[\"a\\nb\"]";
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(escaped, escaped + strlen(escaped), &v));
+  ASSERT_EQ(v.u.array.items->item.flags & JSON_STRING_HAS_ESCAPES, JSON_STRING_HAS_ESCAPES);
+  json_reset();
+
+  ASSERT_TRUE(decodes_to(plain, "plain text without escapes, long enough for a chunk", 51));
+  ASSERT_TRUE(decodes_to("[\"\"]", "", 0));
+  ASSERT_TRUE(decodes_to("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"]", "\"\\/\b\f\n\r\t", 8));
+  ASSERT_TRUE(decodes_to("[\"0123456789abcdef0123\\n456789abcdef\\t\"]", "0123456789abcdef0123\n456789abcdef\t", 34));
+  ASSERT_TRUE(decodes_to("[\"\\u0041\\u00e9\\u20AC\"]", "A\xc3\xa9\xe2\x82\xac", 6));
+  ASSERT_TRUE(decodes_to("[\"\\ud83d\\ude00!\"]", "\xf0\x9f\x98\x80!", 5));
+  ASSERT_TRUE(decodes_to("[\"\\ud83d-\\ude00\"]", "\xef\xbf\xbd-\xef\xbf\xbd", 7));
+  ASSERT_TRUE(decodes_to("[\"\\u0000\"]", "\0", 1));
+
+  memset(&v, 0, sizeof(json_value));
+  v.type = J_NUMBER;
+  ASSERT_TRUE(json_string_decode(&v, (char *)plain) == JSON_DECODE_ERROR);
+  ASSERT_TRUE(json_string_decode(NULL, (char *)plain) == JSON_DECODE_ERROR);
+  END_TEST;
+}
+
+TEST(test_json_parse_in_situ) {
+  char source[] = "{\"k\\u00e9y\":[\"a\\tb\",\"plain\",\"\\ud83d\\ude00\\\\\"],\"n\":1}";
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_in_situ(source, source + strlen(source), &v));
+  json_object_node *key = v.u.object.items;
+  ASSERT_TRUE(key->item.key.len == 4 && memcmp(key->item.key.ptr, "k\xc3\xa9y", 4) == 0);
+  json_array_node *item = key->item.value.u.array.items;
+  ASSERT_TRUE(item->item.u.string.len == 3 && memcmp(item->item.u.string.ptr, "a\tb", 3) == 0);
+  ASSERT_EQ(item->item.flags & JSON_STRING_HAS_ESCAPES, 0);
+  item = item->next;
+  ASSERT_TRUE(item->item.u.string.len == 5 && memcmp(item->item.u.string.ptr, "plain", 5) == 0);
+  item = item->next;
+  ASSERT_TRUE(item->item.u.string.len == 5 && memcmp(item->item.u.string.ptr, "\xf0\x9f\x98\x80\\", 5) == 0);
+  ASSERT_TRUE(key->next->item.key.len == 1 && key->next->item.key.ptr[0] == 'n');
+  json_reset();
+
+  char invalid[] = "[\"a\\nb\",]";
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_in_situ(invalid, invalid + strlen(invalid), &v));
+  json_reset();
+  END_TEST;
+}
+
+static bool key_decodes_to(const json_object_node *node, const char *expected) {
+  char buffer[DECODE_BUFFER_SIZE];
+  size_t len = json_key_decode(&node->item, buffer);
+  return len == strlen(expected) && memcmp(buffer, expected, len) == 0;
+}
+
+TEST(test_json_key_decode) {
+  const char *source = "{\"a\\nb\":{\"plain\":1},\"\\u00e9\":[2]}";
+  /* keys are matched raw, so the path spells the escape the way the input does */
+  const char *paths[] = {"a\\nb.plain"};
+  json_projection *projection;
+  json_stream stream;
+  json_arena *arena;
+  json_cursor cursor;
+  reference key;
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse(source, source + strlen(source), &v));
+  ASSERT_EQ(v.u.object.items->item.value.key_flags & JSON_STRING_HAS_ESCAPES, JSON_STRING_HAS_ESCAPES);
+  ASSERT_TRUE(key_decodes_to(v.u.object.items, "a\nb"));
+  ASSERT_TRUE(key_decodes_to(v.u.object.items->next, "\xc3\xa9"));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + strlen(source), &v));
+  ASSERT_TRUE(key_decodes_to(v.u.object.items, "a\nb"));
+  ASSERT_EQ(v.u.object.items->item.value.u.object.items->item.value.key_flags, 0);
+  ASSERT_TRUE(key_decodes_to(v.u.object.items->item.value.u.object.items, "plain"));
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  json_stream_init(&stream, &v);
+  ASSERT_TRUE(json_stream_feed(&stream, source, strlen(source)) == JSON_STREAM_DONE);
+  ASSERT_TRUE(key_decodes_to(v.u.object.items->next, "\xc3\xa9"));
+  json_stream_free(&stream);
+  json_reset();
+  projection = json_projection_compile(paths, 1);
+  ASSERT_PTR_NOT_NULL(projection);
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_projected(source, source + strlen(source), projection, &v));
+  ASSERT_TRUE(key_decodes_to(v.u.object.items, "a\nb"));
+  json_projection_free(projection);
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_parallel(source, source + strlen(source), 2, &v, &arena));
+  ASSERT_TRUE(key_decodes_to(v.u.object.items, "a\nb"));
+  ASSERT_TRUE(key_decodes_to(v.u.object.items->next, "\xc3\xa9"));
+  json_arena_free(arena);
+  json_cursor_init(&cursor, source, source + strlen(source));
+  ASSERT_TRUE(json_cursor_next(&cursor, NULL, &v));
+  ASSERT_TRUE(json_cursor_next(&cursor, &key, &v) && v.key_flags == JSON_STRING_HAS_ESCAPES);
+  ASSERT_TRUE(json_cursor_next(&cursor, &key, &v) && v.key_flags == 0);
+  ASSERT_TRUE(json_key_decode(NULL, (char *)source) == JSON_DECODE_ERROR);
+  END_TEST;
+}
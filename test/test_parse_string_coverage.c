@@ -118,4 +118,38 @@ TEST(test_parse_string_full_coverage) {
   json_free(&test_val);
 
   END_TEST;
-}
\ No newline at end of file
+}
+TEST(test_parse_string_control_characters) {
+  json_value test_val;
+
+  /* control character inside the 16-byte vector loop */
+  const char *test1 = "[\"0123456789\x01" "abcdefghijklmnop\"]";
+  memset(&test_val, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(test1, test1 + strlen(test1), &test_val));
+  json_reset();
+
+  /* control character in the scalar tail */
+  const char *test2 = "[\"abc\x1f\"]";
+  memset(&test_val, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(test2, test2 + strlen(test2), &test_val));
+  json_reset();
+
+  /* control character after an escape sequence */
+  const char *test3 = "[\"\\n0123456789abcdef\t0123456789abcdef\"]";
+  memset(&test_val, 0, sizeof(json_value));
+  ASSERT_FALSE(json_parse_iterative(test3, test3 + strlen(test3), &test_val));
+  json_reset();
+
+  /* raw newline in an object key */
+  const char *test4 = "{\"ke\ny\": 1}";
+  ASSERT_EQ(json_validate(test4, test4 + strlen(test4)), E_EXPECTED_OBJECT_KEY);
+
+  /* bytes >= 0x80 and DEL are not control characters */
+  const char *test5 = "[\"\xc3\xa9\xe2\x82\xac 0123456789abcdef\x7f\xf0\x9f\x98\x80\"]";
+  memset(&test_val, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(test5, test5 + strlen(test5), &test_val));
+  ASSERT_EQ(test_val.u.array.items->item.u.string.len, strlen(test5) - 4);
+  json_reset();
+
+  END_TEST;
+}
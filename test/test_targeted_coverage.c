@@ -319,4 +319,55 @@ TEST(test_json_stringify_buffer_error_coverage) {
   ASSERT_PTR_NULL(null_output);
 
   END_TEST;
-}
\ No newline at end of file
+}
+TEST(test_value_dispatch_literals_coverage) {
+  static const char *valid[] = {"[true,false,null]", "{\"a\":true,\"b\":false,\"c\":null}", "[[null],[false],[-1,0,\"x\"]]"};
+  static const char *invalid[] = {"[tru]", "[nul", "[fals", "[falsy]", "[nulL]", "[True]", "[+1]", "[.5]", "[x]", "{\"a\":t}", "[truex]"};
+  size_t i;
+  for (i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    const char *end = valid[i] + strlen(valid[i]);
+    json_value v;
+    memset(&v, 0, sizeof(json_value));
+    ASSERT_EQ(json_validate(valid[i], end), E_OK);
+    ASSERT_TRUE(json_parse(valid[i], end, &v));
+    json_reset();
+    memset(&v, 0, sizeof(json_value));
+    ASSERT_TRUE(json_parse_iterative(valid[i], end, &v));
+    json_reset();
+  }
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    const char *end = invalid[i] + strlen(invalid[i]);
+    json_value v;
+    memset(&v, 0, sizeof(json_value));
+    ASSERT_TRUE(json_validate(invalid[i], end) != E_OK);
+    ASSERT_FALSE(json_parse(invalid[i], end, &v));
+    json_reset();
+    memset(&v, 0, sizeof(json_value));
+    ASSERT_FALSE(json_parse_iterative(invalid[i], end, &v));
+    json_reset();
+  }
+  END_TEST;
+}
+
+TEST(test_parse_stack_growth_coverage) {
+  /* nesting far beyond the initial depth stack forces it onto the heap */
+  const size_t depth = 5000;
+  char *source = (char *)malloc(depth * 2);
+  json_value v;
+  ASSERT_PTR_NOT_NULL(source);
+  memset(source, '[', depth);
+  memset(source + depth, ']', depth);
+  ASSERT_EQ(json_validate(source, source + depth * 2), E_OK);
+  json_reset();
+  memset(&v, 0, sizeof(json_value));
+  ASSERT_TRUE(json_parse_iterative(source, source + depth * 2, &v));
+  json_reset();
+  /* the grown stack is kept for the next call and released by json_cleanup() */
+  ASSERT_EQ(json_validate(source, source + depth * 2), E_OK);
+  json_reset();
+  json_cleanup();
+  ASSERT_EQ(json_validate(source, source + depth * 2 - 1), E_INVALID_JSON);
+  json_reset();
+  free(source);
+  END_TEST;
+}
@@ -0,0 +1,55 @@
+#include "../src/json.h"
+#include "../test/test.h"
+
+static bool parse_string_value(const char *source) {
+  json_value v;
+  memset(&v, 0, sizeof(json_value));
+  bool result = json_parse_iterative(source, source + strlen(source), &v);
+  json_reset();
+  return result;
+}
+
+TEST(test_utf8_validation_valid) {
+  /* 2, 3 and 4 byte sequences, boundaries of each range */
+  ASSERT_TRUE(parse_string_value("[\"\xc2\x80\xdf\xbf\"]"));
+  ASSERT_TRUE(parse_string_value("[\"\xe0\xa0\x80\xed\x9f\xbf\xee\x80\x80\xef\xbf\xbf\"]"));
+  ASSERT_TRUE(parse_string_value("[\"\xf0\x90\x80\x80\xf4\x8f\xbf\xbf\"]"));
+  /* multi-byte sequences crossing 16-byte block boundaries */
+  ASSERT_TRUE(parse_string_value("[\"0123456789abcd\xe2\x82\xac\xf0\x9f\x98\x80 0123456789abcdef\xc3\xa9\"]"));
+  /* non-ASCII bytes after the closing quote of an ASCII string in the same block */
+  ASSERT_TRUE(parse_string_value("[\"ab\",\"\xc3\xa9\",\"\xe2\x82\xac\"]"));
+  /* escapes next to non-ASCII text */
+  ASSERT_TRUE(parse_string_value("{\"\xc3\xa9t\xc3\xa9\": \"\\u00e9\\n\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\\\"\"}"));
+  ASSERT_EQ(json_validate("[\"\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82\"]", "[\"\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82\"]" + 16), E_OK);
+  END_TEST;
+}
+
+TEST(test_utf8_validation_invalid) {
+#if UTF8_VALIDATION
+  /* stray continuation byte */
+  ASSERT_FALSE(parse_string_value("[\"\x80\"]"));
+  /* overlong encodings */
+  ASSERT_FALSE(parse_string_value("[\"\xc0\xaf\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xc1\xbf\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xe0\x9f\xbf\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xf0\x8f\xbf\xbf\"]"));
+  /* UTF-16 surrogates */
+  ASSERT_FALSE(parse_string_value("[\"\xed\xa0\x80\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xed\xbf\xbf\"]"));
+  /* above U+10FFFF and invalid lead bytes */
+  ASSERT_FALSE(parse_string_value("[\"\xf4\x90\x80\x80\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xf5\x80\x80\x80\"]"));
+  ASSERT_FALSE(parse_string_value("[\"\xff\"]"));
+  /* truncated sequences before the closing quote, in the tail and in a full block */
+  ASSERT_FALSE(parse_string_value("[\"\xe2\x82\"]"));
+  ASSERT_FALSE(parse_string_value("[\"0123456789abcdef\xf0\x9f\x98\"]"));
+  ASSERT_FALSE(parse_string_value("[\"0123456789abcd\xe2\x82 0123456789abcdef\"]"));
+  /* invalid bytes in the block that stops at an escape or at the closing quote */
+  ASSERT_FALSE(parse_string_value("[\"\xff\\n0123456789abcdef\"]"));
+  ASSERT_FALSE(parse_string_value("[\"ab\xc3\", \"0123456789abcdef\"]"));
+  /* invalid bytes in object keys are reported by the validator as well */
+  ASSERT_EQ(json_validate("{\"\xc3\": 1}", "{\"\xc3\": 1}" + 8), E_EXPECTED_OBJECT_KEY);
+  ASSERT_EQ(json_validate("[\"\xed\xa0\x80\"]", "[\"\xed\xa0\x80\"]" + 7), E_EXPECTED_STRING);
+#endif
+  END_TEST;
+}